@@ -8,6 +8,8 @@ if(Vulkan_FOUND)
     MESSAGE("Vulkan Found!")
 endif()
 
+find_package(Threads REQUIRED)
+
 include(FetchContent)
 
 # Fetch GLFW
@@ -35,5 +37,6 @@ target_link_libraries(${PROJECT_NAME} PUBLIC
 	Vulkan::Vulkan
 	glfw
     glm::glm
+    Threads::Threads
 )
 
@@ -3,14 +3,15 @@
 
 layout(push_constant) uniform PushConstants
 {
-    mat4 view;
-    mat4 proj;
+    mat4 viewProj;
+    uint domeSegmentsLat;
+    uint domeSegmentsLon;
+    float domeRadius;
 } pc;
 
 #include "Helper_Scattering.glsl"
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
+#include "Helper_Vertex.glsl"
 
 layout(location = 0) out vec3 outColor;
 layout(location = 1) out vec3 outAttenuation;
@@ -20,10 +21,12 @@ layout(location = 1) out vec3 outAttenuation;
 // This means that the ray along which we will sample starts at the camera and ends at the current vertex
 void main()
 {
+    vec3 position = GetVertexPosition();
+
     // Get the ray from the Camera to the current Vertex,
     // the length of this ray is the far point of the ray passing through the atmosphere
     vec3 startPos = cameraPos;
-    vec3 endPos = inPosition;
+    vec3 endPos = position;
     vec3 ray = endPos - startPos;
     float farDistance = length(ray);
     ray /= farDistance;
@@ -43,7 +46,7 @@ void main()
 
     // Initialize the scattering loop variables
     float travelDistance = farDistance;
-    float sampleLength = travelDistance / sampleCount;
+    float sampleLength = travelDistance / float(GetSampleCount());
     float scaledLength = sampleLength * scale;
     vec3 sampleRay = ray * sampleLength;
     vec3 samplePoint = startPos + sampleRay * 0.5;
@@ -51,7 +54,7 @@ void main()
     // Loop through the sample points
     vec3 frontColor = vec3(0);
     vec3 attentuation;
-    for(int i = 0; i < sampleCount; ++i)
+    for(int i = 0; i < GetSampleCount(); ++i)
     {
         // Calculate the sample depth
         float sampleHeightOffGround = length(samplePoint) - innerRadius;
@@ -72,7 +75,7 @@ void main()
     }
 
     // Finally, scale the Mie and Rayleigh Colors
-    gl_Position = pc.proj * pc.view * vec4(inPosition, 1.0);
+    gl_Position = pc.viewProj * vec4(position, 1.0);
 
     outColor = frontColor * (invWaveLength * krESun + kmESun);
     outAttenuation = attentuation;
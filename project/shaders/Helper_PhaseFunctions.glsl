@@ -12,6 +12,10 @@ layout(set = 0, binding = 1) uniform Parameters
 	uint phaseType;					// Which phase function to use
 };
 
+// Specialized pipelines bake the phase function in so the switch below folds away.
+// -1 falls back to the phase type in the uniform buffer.
+layout(constant_id = 1) const int PHASE_TYPE = -1;
+
 // Different Phase Functions
 float Phase_HenyeyGreenstein(float g, float g2, float cosine)
 {
@@ -39,7 +43,7 @@ float Phase_CornetteShanks(float g, float g2, float cosine, float cosine2)
 // Calculates the Mie phase function
 float GetMiePhase(float cosine, float cosine2, float g, float g2)
 {
-    switch(phaseType) 
+    switch(PHASE_TYPE >= 0 ? uint(PHASE_TYPE) : phaseType)
     {
         case 0:
             return Phase_HenyeyGreenstein(g, g2, cosine);
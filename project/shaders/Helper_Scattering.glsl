@@ -25,6 +25,14 @@ layout(set = 0, binding = 0) uniform Parameters
     float km4PI;					// Km * 4 * PI
 };
 
+// Specialized pipelines bake the sample count in so the scattering loops can be unrolled.
+// 0 falls back to the count in the uniform buffer.
+layout(constant_id = 0) const int SAMPLE_COUNT = 0;
+int GetSampleCount()
+{
+    return SAMPLE_COUNT > 0 ? SAMPLE_COUNT : int(sampleCount);
+}
+
 float Scale(float cosine, float scaleDepth)
 {
 	float x = 1.0 - cosine;
@@ -0,0 +1,77 @@
+// input
+// Every vertex layout is read as a vec4, components the vertex format does not have read as 0 (w as 1)
+layout(location = 0) in vec4 inPackedPosition;
+
+// How the mesh stores its positions, matches ashen::VertexLayout.
+// 0 float position, 1 snorm16 position divided by the scale, 2 snorm16 octahedral direction times the scale,
+// 3 no vertex buffer, the dome is generated from the push constants (the including shader declares them as pc),
+// 4 a quadtree patch per instance (theta, phi, size, coarser edges), the vertex index is the place in the patch's grid.
+// Every layout holds a unit dome, each draw scales it to its own radius.
+layout(constant_id = 2) const int VERTEX_LAYOUT = 0;
+layout(constant_id = 3) const float VERTEX_SCALE = 1.0;
+
+vec2 SignNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Unfolds the lower half of the octahedron back over the diagonals
+vec3 DecodeOctahedral(vec2 oct)
+{
+    vec3 dir = vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));
+    if (dir.z < 0.0)
+        dir.xy = (1.0 - abs(dir.yx)) * SignNotZero(dir.xy);
+    return normalize(dir);
+}
+
+// One triangle strip per ring of the dome, drawn as instances, the vertices alternate between the lower & upper edge of the ring.
+// Same grid & winding as Renderer::CreateDome, the last segment reuses the first so the seam is closed exactly.
+vec3 GetDomePosition()
+{
+    const uint lat = uint(gl_InstanceIndex) + ((gl_VertexIndex & 1) == 0 ? 1u : 0u);
+    const uint lon = uint(gl_VertexIndex >> 1) % pc.domeSegmentsLon;
+
+    const float theta = 1.57079632679 * float(lat) / float(pc.domeSegmentsLat);
+    const float phi = 6.28318530718 * float(lon) / float(pc.domeSegmentsLon);
+    return vec3(cos(phi) * sin(theta), cos(theta), sin(phi) * sin(theta));
+}
+
+// Theta runs from +x and phi around x towards +y, so the poles of the patches lie on the rim and not overhead.
+// Rows follow theta & columns phi, the same winding as Renderer::CreateDome, see ashen::DomeLod.
+vec3 GetPatchDirection(vec4 patch, uvec2 cell)
+{
+    const vec2 angles = patch.xy + patch.z * vec2(cell.yx) / float(pc.domeSegmentsLon);
+    return vec3(cos(angles.x), sin(angles.y) * sin(angles.x), cos(angles.y) * sin(angles.x));
+}
+
+// Edges next to a coarser patch move every odd vertex onto the middle of its neighbours,
+// the coarser patch's edge runs straight through there, so both levels meet without cracks
+vec3 GetPatchPosition()
+{
+    const uint gridSize = pc.domeSegmentsLon;
+    const uvec2 cell = uvec2(uint(gl_VertexIndex) % (gridSize + 1), uint(gl_VertexIndex) / (gridSize + 1));
+    const uint coarserEdges = uint(inPackedPosition.w);
+
+    const bool coarserRow = ((coarserEdges & 1u) != 0 && cell.y == 0) || ((coarserEdges & 2u) != 0 && cell.y == gridSize);
+    const bool coarserColumn = ((coarserEdges & 4u) != 0 && cell.x == 0) || ((coarserEdges & 8u) != 0 && cell.x == gridSize);
+    if (coarserRow && (cell.x & 1u) != 0)
+        return 0.5 * (GetPatchDirection(inPackedPosition, cell - uvec2(1, 0)) + GetPatchDirection(inPackedPosition, cell + uvec2(1, 0)));
+    if (coarserColumn && (cell.y & 1u) != 0)
+        return 0.5 * (GetPatchDirection(inPackedPosition, cell - uvec2(0, 1)) + GetPatchDirection(inPackedPosition, cell + uvec2(0, 1)));
+    return GetPatchDirection(inPackedPosition, cell);
+}
+
+// Object space position of the current vertex, whatever layout it is stored in
+vec3 GetVertexPosition()
+{
+    vec3 unitPosition = inPackedPosition.xyz;
+    if (VERTEX_LAYOUT == 1)
+        unitPosition = inPackedPosition.xyz * VERTEX_SCALE;
+    else if (VERTEX_LAYOUT == 2)
+        unitPosition = DecodeOctahedral(inPackedPosition.xy) * VERTEX_SCALE;
+    else if (VERTEX_LAYOUT == 3)
+        unitPosition = GetDomePosition();
+    else if (VERTEX_LAYOUT == 4)
+        unitPosition = GetPatchPosition();
+    return unitPosition * pc.domeRadius;
+}
@@ -3,14 +3,15 @@
 
 layout(push_constant) uniform PushConstants
 {
-    mat4 view;
-    mat4 proj;
+    mat4 viewProj;
+    uint domeSegmentsLat;
+    uint domeSegmentsLon;
+    float domeRadius;
 } pc;
 
 #include "Helper_Scattering.glsl"
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
+#include "Helper_Vertex.glsl"
 
 layout(location = 0) out vec3 outRayleighColor;
 layout(location = 1) out vec3 outMieColor;
@@ -21,10 +22,12 @@ layout(location = 2) out vec3 outDirectionToCam;
 // This means that the ray along which we will sample starts at the camera and ends at the current vertex
 void main()
 {
+    vec3 position = GetVertexPosition();
+
     // Get the ray from the Camera to the current Vertex,
     // the length of this ray is the far point of the ray passing through the atmosphere
     vec3 startPos = cameraPos;
-    vec3 endPos = inPosition;
+    vec3 endPos = position;
     vec3 ray = endPos - startPos;
     float farDistance = length(ray);
     ray /= farDistance;
@@ -34,14 +37,14 @@ void main()
 
     // Initialize the scattering loop variables
     float travelDistance = farDistance;
-    float sampleLength = travelDistance / sampleCount;
+    float sampleLength = travelDistance / float(GetSampleCount());
     float scaledLength = sampleLength * scale;
     vec3 sampleRay = ray * sampleLength;
     vec3 samplePoint = startPos + sampleRay * 0.5;
 
     // Loop through the sample points
     vec3 frontColor = vec3(0);
-    for(int i = 0; i < sampleCount; ++i)
+    for(int i = 0; i < GetSampleCount(); ++i)
     {
         // Calculate the sample depth
         float sampleHeightOffGround = length(samplePoint) - innerRadius;
@@ -66,10 +69,10 @@ void main()
     }
 
     // Finally, scale the Mie and Rayleigh Colors
-    gl_Position = pc.proj * pc.view * vec4(inPosition, 1.0);
+    gl_Position = pc.viewProj * vec4(position, 1.0);
 
     outRayleighColor = frontColor * (invWaveLength * krESun);
     outMieColor = frontColor * kmESun;
 
-    outDirectionToCam = cameraPos - inPosition;
+    outDirectionToCam = cameraPos - position;
 }
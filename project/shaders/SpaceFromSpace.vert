@@ -1,9 +1,12 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
 layout(push_constant) uniform PushConstants
 {
-    mat4 view;
-    mat4 proj;
+    mat4 viewProj;
+    uint domeSegmentsLat;
+    uint domeSegmentsLon;
+    float domeRadius;
 } pc;
 
 layout(set = 0, binding = 0) uniform TestParams
@@ -11,14 +14,17 @@ layout(set = 0, binding = 0) uniform TestParams
 	float eT;
 } time;
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
+#include "Helper_Vertex.glsl"
 
 layout(location = 0) out vec3 fragColor;
 
+const vec3 BASE_COLOR = vec3(0.5);
+
 void main()
 {
-    gl_Position = pc.proj * pc.view * vec4(inPosition, 1.0);
+    vec3 position = GetVertexPosition();
+
+    gl_Position = pc.viewProj * vec4(position, 1.0);
     vec3 timeOffset = sin(vec3(time.eT, time.eT * 1.3, time.eT * 1.7)) * 0.5 + 0.5;
-    fragColor = inColor * timeOffset;
+    fragColor = BASE_COLOR * timeOffset;
 }
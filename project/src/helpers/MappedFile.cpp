@@ -0,0 +1,97 @@
+// -- Standard Library --
+#include <stdexcept>
+
+// -- Platform Includes --
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// -- Ashen Includes --
+#include "MappedFile.h"
+
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  MappedFile
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+#ifdef _WIN32
+ashen::MappedFile::MappedFile(const std::string& path)
+{
+	m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Failed to open file: " + path);
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(m_File);
+		throw std::runtime_error("Failed to map empty or unreadable file: " + path);
+	}
+	m_Size = static_cast<size_t>(size.QuadPart);
+
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_Mapping)
+		m_pData = static_cast<const std::byte*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_pData)
+	{
+		if (m_Mapping) CloseHandle(m_Mapping);
+		CloseHandle(m_File);
+		throw std::runtime_error("Failed to map file: " + path);
+	}
+}
+ashen::MappedFile::~MappedFile()
+{
+	UnmapViewOfFile(m_pData);
+	CloseHandle(m_Mapping);
+	CloseHandle(m_File);
+}
+#else
+ashen::MappedFile::MappedFile(const std::string& path)
+{
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("Failed to open file: " + path);
+
+	struct stat info{};
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		throw std::runtime_error("Failed to map empty or unreadable file: " + path);
+	}
+	m_Size = static_cast<size_t>(info.st_size);
+
+	// The mapping keeps its own reference to the file, the descriptor is not needed afterwards
+	void* pData = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (pData == MAP_FAILED)
+		throw std::runtime_error("Failed to map file: " + path);
+	m_pData = static_cast<const std::byte*>(pData);
+}
+ashen::MappedFile::~MappedFile()
+{
+	munmap(const_cast<std::byte*>(m_pData), m_Size);
+}
+#endif
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+const std::byte* ashen::MappedFile::GetData() const
+{
+	return m_pData;
+}
+size_t ashen::MappedFile::GetSize() const
+{
+	return m_Size;
+}
@@ -0,0 +1,46 @@
+#ifndef ASHEN_MAPPED_FILE_H
+#define ASHEN_MAPPED_FILE_H
+
+// -- Standard Library --
+#include <cstddef>
+#include <string>
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  MappedFile
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Read-only view of a whole file mapped into memory, the OS pages it in on demand instead of copying it into a buffer.
+	// The mapping starts on a page boundary, so its contents can be reinterpreted as any naturally aligned type.
+	class MappedFile final
+	{
+	public:
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile(MappedFile&& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+		MappedFile& operator=(MappedFile&& other) = delete;
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		const std::byte* GetData() const;
+		size_t GetSize() const;
+
+	private:
+		const std::byte* m_pData{};
+		size_t m_Size{};
+
+#ifdef _WIN32
+		void* m_File{};
+		void* m_Mapping{};
+#endif
+	};
+}
+
+#endif // ASHEN_MAPPED_FILE_H
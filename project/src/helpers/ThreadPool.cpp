@@ -0,0 +1,64 @@
+// -- Standard Library --
+#include <algorithm>
+
+// -- Ashen Includes --
+#include "ThreadPool.h"
+
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  ThreadPool
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::ThreadPool::ThreadPool(uint32_t threadCount)
+{
+	threadCount = std::max(threadCount, 1u);
+	m_vWorkers.reserve(threadCount);
+	for (uint32_t worker{}; worker < threadCount; ++worker)
+		m_vWorkers.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+}
+ashen::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+
+	// Queued tasks are still drained, nobody is left waiting on a broken promise
+	for (std::thread& worker : m_vWorkers)
+		worker.join();
+}
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+uint32_t ashen::ThreadPool::GetThreadCount() const
+{
+	return static_cast<uint32_t>(m_vWorkers.size());
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+void ashen::ThreadPool::WorkerLoop(uint32_t worker)
+{
+	while (true)
+	{
+		std::function<void(uint32_t)> task;
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_Condition.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Tasks.empty())
+				return;
+
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop();
+		}
+		task(worker);
+	}
+}
@@ -0,0 +1,75 @@
+#ifndef ASHEN_THREAD_POOL_H
+#define ASHEN_THREAD_POOL_H
+
+// -- Standard Library --
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  ThreadPool
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Fixed set of workers pulling from one FIFO queue.
+	// Tasks receive the index of the worker running them, so they can use per-worker resources without locking.
+	class ThreadPool final
+	{
+	public:
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit ThreadPool(uint32_t threadCount);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool& other) = delete;
+		ThreadPool(ThreadPool&& other) = delete;
+		ThreadPool& operator=(const ThreadPool& other) = delete;
+		ThreadPool& operator=(ThreadPool&& other) = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Exceptions thrown by the task are rethrown from the future's get()
+		template<typename Func>
+		std::future<std::invoke_result_t<Func, uint32_t>> Submit(Func&& func);
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		uint32_t GetThreadCount() const;
+
+	private:
+		std::vector<std::thread> m_vWorkers{};
+		std::queue<std::function<void(uint32_t)>> m_Tasks{};
+		std::mutex m_Mutex{};
+		std::condition_variable m_Condition{};
+		bool m_Stopping{};
+
+		void WorkerLoop(uint32_t worker);
+	};
+
+	template<typename Func>
+	std::future<std::invoke_result_t<Func, uint32_t>> ThreadPool::Submit(Func&& func)
+	{
+		using Result = std::invoke_result_t<Func, uint32_t>;
+
+		// std::function has to be copyable, the packaged task is not, so it is shared
+		auto pTask = std::make_shared<std::packaged_task<Result(uint32_t)>>(std::forward<Func>(func));
+		std::future<Result> future = pTask->get_future();
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_Tasks.emplace([pTask](uint32_t worker) { (*pTask)(worker); });
+		}
+		m_Condition.notify_one();
+		return future;
+	}
+}
+
+#endif // ASHEN_THREAD_POOL_H
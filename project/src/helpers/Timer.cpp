@@ -19,6 +19,8 @@ void ashen::Timer::Start()
 	m_CurrentTimePoint = std::chrono::high_resolution_clock::now();
 	m_DeltaTimeSeconds = 0;
 	m_SleepTimeSeconds = 0;
+	m_TotalTimeSeconds = 0;
+	m_Ticks = 0;
 }
 void ashen::Timer::Update()
 {
@@ -26,9 +28,15 @@ void ashen::Timer::Update()
 
 	m_CurrentTimePoint = std::chrono::high_resolution_clock::now();
 	m_DeltaTimeSeconds = std::chrono::duration<float>(m_CurrentTimePoint - m_LastTimePoint).count();
+	if (m_FixedDeltaSeconds > 0.f)
+		m_DeltaTimeSeconds = m_FixedDeltaSeconds;
 	m_LastTimePoint = m_CurrentTimePoint;
 	m_TotalTimeSeconds += m_DeltaTimeSeconds;
 }
+void ashen::Timer::SetFixedDeltaSeconds(float seconds)
+{
+	m_FixedDeltaSeconds = seconds;
+}
 
 void ashen::Timer::StartBenchmark()
 {
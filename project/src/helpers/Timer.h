@@ -29,6 +29,7 @@ namespace ashen
 		//--------------------------------------------------
 		static void Start();
 		static void Update();
+		static void SetFixedDeltaSeconds(float seconds);
 
 		static void StartBenchmark();
 		static float EndBenchmark(bool printResults, const std::string& txt = "");
@@ -52,6 +53,7 @@ namespace ashen
 		inline static float				m_TotalTimeSeconds	{ };
 		inline static float				m_DeltaTimeSeconds	{ };
 		inline static float				m_SleepTimeSeconds	{ };
+		inline static float				m_FixedDeltaSeconds	{ };	// when > 0, Update advances by this instead of wall-clock time
 
 		inline static int				m_Ticks				{ };
 
@@ -0,0 +1,64 @@
+#ifndef ASHEN_TRIPLE_BUFFER_H
+#define ASHEN_TRIPLE_BUFFER_H
+
+// -- Standard Library --
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  TripleBuffer
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Lock-free hand-off of the latest value from exactly one producer thread to exactly one consumer thread.
+	// The producer fills its private slot and publishes it, the consumer swaps in whatever was published last.
+	// Neither side ever waits, values the consumer did not get to in time are simply skipped.
+	template<typename T>
+	class TripleBuffer final
+	{
+	public:
+		//--------------------------------------------------
+		//    Producer
+		//--------------------------------------------------
+		T& GetWriteBuffer()
+		{
+			return m_Buffers[m_WriteIndex];
+		}
+		void Publish()
+		{
+			// The written slot becomes the shared one, the previously shared (stale or unread) slot is written next
+			const uint8_t previous = m_SharedState.exchange(static_cast<uint8_t>(m_WriteIndex | DIRTY_BIT), std::memory_order_acq_rel);
+			m_WriteIndex = static_cast<uint8_t>(previous & INDEX_MASK);
+		}
+
+		//--------------------------------------------------
+		//    Consumer
+		//--------------------------------------------------
+		// Returns true if a newer value was published since the last call, the read buffer is left untouched otherwise
+		bool Consume()
+		{
+			if ((m_SharedState.load(std::memory_order_relaxed) & DIRTY_BIT) == 0)
+				return false;
+
+			const uint8_t previous = m_SharedState.exchange(m_ReadIndex, std::memory_order_acq_rel);
+			m_ReadIndex = static_cast<uint8_t>(previous & INDEX_MASK);
+			return true;
+		}
+		const T& GetReadBuffer() const
+		{
+			return m_Buffers[m_ReadIndex];
+		}
+
+	private:
+		static constexpr uint8_t INDEX_MASK = 0b011;
+		static constexpr uint8_t DIRTY_BIT = 0b100;
+
+		std::array<T, 3> m_Buffers{};
+		std::atomic<uint8_t> m_SharedState{ 1 };
+		uint8_t m_WriteIndex{ 0 };                  // Only touched by the producer
+		uint8_t m_ReadIndex{ 2 };                   // Only touched by the consumer
+	};
+}
+
+#endif // ASHEN_TRIPLE_BUFFER_H
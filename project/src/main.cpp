@@ -1,26 +1,132 @@
 // -- Standard Library --
+#include <atomic>
+#include <exception>
 #include <iostream>
+#include <string>
+#include <thread>
 
 // -- Ashen Includes --
+#include "Benchmark.h"
 #include "Renderer.h"
 #include "Timer.h"
 #include "Window.h"
 #include "ConsoleTextSettings.h"
 using namespace ashen;
 
-int main()
+int main(int argc, char* argv[])
 {
-	std::unique_ptr<Window> pWindow = std::make_unique<Window>(800, 600, "Ashen");
-    std::unique_ptr<Renderer> pRenderer = std::make_unique<Renderer>(pWindow.get());
+    // -- Arguments --
+    bool headless = false;
+    bool serial = false;
+    int width = 800;
+    int height = 600;
+    uint64_t frameLimit = 0;
+    std::string benchmarkScript{};
+    RendererSettings settings{};
+    for (int i{ 1 }; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--headless")                        headless = true;
+        else if (arg == "--serial")                     serial = true;
+        else if (arg == "--no-pipeline-library")        settings.pipelineLibrary = false;
+        else if (arg == "--width" && i + 1 < argc)      width = std::stoi(argv[++i]);
+        else if (arg == "--height" && i + 1 < argc)     height = std::stoi(argv[++i]);
+        else if (arg == "--frames" && i + 1 < argc)     frameLimit = std::stoull(argv[++i]);
+        else if (arg == "--benchmark" && i + 1 < argc)  benchmarkScript = argv[++i];
+        else if (arg == "--frames-in-flight" && i + 1 < argc) settings.framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--record-threads" && i + 1 < argc) settings.recordingThreads = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--hdr-format" && i + 1 < argc)
+        {
+            const std::string format = argv[++i];
+            if (format == "r11g11b10")      settings.hdrFormat = HDRFormat::B10G11R11;
+            else if (format == "rgba16f")   settings.hdrFormat = HDRFormat::RGBA16F;
+            else if (format == "rgba32f")   settings.hdrFormat = HDRFormat::RGBA32F;
+            else std::cout << WARNING_TXT << "Unknown HDR format: " << format << RESET_TXT << "\n";
+        }
+        else if (arg == "--vertex-layout" && i + 1 < argc)
+        {
+            const std::string layout = argv[++i];
+            if (layout == "float3")             settings.vertexLayout = VertexLayout::Position;
+            else if (layout == "snorm16")       settings.vertexLayout = VertexLayout::UnitSphere16;
+            else if (layout == "octahedral")    settings.vertexLayout = VertexLayout::Octahedral16;
+            else if (layout == "procedural")    settings.vertexLayout = VertexLayout::Procedural;
+            else std::cout << WARNING_TXT << "Unknown vertex layout: " << layout << RESET_TXT << "\n";
+        }
+        else if (arg == "--keep-mesh-data")             settings.keepMeshData = true;
+        else if (arg == "--no-mesh-optimization")       settings.optimizeMeshes = false;
+        else if (arg == "--no-dome-lod")                settings.domeLod = false;
+        else if (arg == "--lod-error" && i + 1 < argc)  settings.domeLodPixelError = std::stof(argv[++i]);
+        else std::cout << WARNING_TXT << "Unknown argument: " << arg << RESET_TXT << "\n";
+    }
+
+    // Headless runs have nobody to close the window, so they stop after a fixed amount of frames
+    if (headless && frameLimit == 0)
+        frameLimit = 1000;
 
+	std::unique_ptr<Window> pWindow = std::make_unique<Window>(width, height, "Ashen", headless);
+    std::unique_ptr<Renderer> pRenderer = std::make_unique<Renderer>(pWindow.get(), settings);
+
+    if (!benchmarkScript.empty())
+    {
+        Benchmark benchmark{ benchmarkScript };
+        benchmark.Run(pWindow.get(), pRenderer.get());
+        return 0;
+    }
+
+    uint64_t frame = 0;
     Timer::Start();
-    while (!pWindow->ShouldClose())
+
+    // -- Serial: headless frame limits count rendered frames, so those runs always update and render in lockstep --
+    if (serial || headless)
+    {
+        while (!pWindow->ShouldClose())
+        {
+            Timer::Update();
+            pWindow->PollEvents();
+            pRenderer->Update();
+            pRenderer->Render();
+
+            if (frameLimit != 0 && ++frame >= frameLimit)
+                pWindow->Close();
+        }
+        return 0;
+    }
+
+    // -- Threaded: GLFW events & input have to stay on the main thread, so it runs the updates and rendering moves out --
+    // The render thread never waits on an update, it renders the last published snapshot again when there is nothing newer
+    std::atomic<bool> rendering{ true };
+    std::exception_ptr pRenderError{};
+    std::thread renderThread([&]()
+    {
+        try
+        {
+            while (rendering)
+                pRenderer->Render();
+        }
+        catch (...)
+        {
+            pRenderError = std::current_exception();
+            rendering = false;
+        }
+    });
+
+    while (rendering && !pWindow->ShouldClose())
     {
         Timer::Update();
         pWindow->PollEvents();
         pRenderer->Update();
-        pRenderer->Render();
+
+        if (frameLimit != 0 && ++frame >= frameLimit)
+            pWindow->Close();
+
+        // Updates tick at the target rate instead of spinning a core on input & stats output
+        std::this_thread::sleep_for(Timer::SleepDurationNanoSeconds());
     }
 
+    rendering = false;
+    renderThread.join();
+    if (pRenderError)
+        std::rethrow_exception(pRenderError);
+
     return 0;
 }
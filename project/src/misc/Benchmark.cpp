@@ -0,0 +1,386 @@
+// -- Standard Library --
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+// -- Ashen Includes --
+#include "Benchmark.h"
+#include "ConsoleTextSettings.h"
+#include "Renderer.h"
+#include "Timer.h"
+#include "Window.h"
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::Benchmark::Benchmark(const std::string& scriptPath)
+{
+    ParseScript(scriptPath);
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+void ashen::Benchmark::Run(Window* pWindow, Renderer* pRenderer)
+{
+    BuildCases();
+    m_vRecords.clear();
+    m_vRecords.reserve(m_vCases.size() * m_RecordedFrames);
+    m_vGpuScopes = pRenderer->GetGpuScopeNames();
+    m_HeapCount = static_cast<uint32_t>(pRenderer->GetHeapStats().size());
+
+    // -- Deterministic Setup --
+    pRenderer->SetInputEnabled(false);
+    Timer::SetFixedDeltaSeconds(m_TimeStep);
+    Timer::Start();
+
+    // GPU timings arrive a few frames late, so remember which record each submitted frame belongs to
+    std::unordered_map<uint64_t, size_t> pendingGpuFrames{};
+    auto collectGpuTimings = [&]()
+    {
+        for (const GpuFrameTiming& timing : pRenderer->ConsumeGpuTimings())
+        {
+            const auto it = pendingGpuFrames.find(timing.frame);
+            if (it == pendingGpuFrames.end()) continue;
+            m_vRecords[it->second].vGpuMilliseconds = timing.vScopeMilliseconds;
+            pendingGpuFrames.erase(it);
+        }
+    };
+
+    std::cout << INFO_TXT << "[Benchmark] " << m_Name << ": " << m_vCases.size() << " case(s), "
+        << m_WarmupFrames << " warmup + " << m_RecordedFrames << " recorded frames each" << RESET_TXT << "\n";
+
+    for (uint32_t caseIndex{}; caseIndex < static_cast<uint32_t>(m_vCases.size()); ++caseIndex)
+    {
+        const Case& c = m_vCases[caseIndex];
+        pRenderer->SetSampleCount(c.samples);
+        pRenderer->SetPhaseFunction(c.phase);
+        pRenderer->SetHDR(c.hdr);
+        pRenderer->SetRayleigh(c.kr);
+        pRenderer->SetMie(c.km);
+
+        std::cout << "[Benchmark] Case " << caseIndex + 1 << "/" << m_vCases.size()
+            << " - Samples: " << c.samples << ", Phase: " << c.phase << ", HDR: " << (c.hdr ? "on" : "off")
+            << ", Kr: " << c.kr << ", Km: " << c.km << "\n";
+
+        const uint32_t totalFrames = m_WarmupFrames + m_RecordedFrames;
+        for (uint32_t frame{}; frame < totalFrames && !pWindow->ShouldClose(); ++frame)
+        {
+            // Warmup frames hold the start of the path, recorded frames replay it from t = 0
+            const bool recorded = frame >= m_WarmupFrames;
+            const float pathTime = recorded ? static_cast<float>(frame - m_WarmupFrames) * m_TimeStep : 0.f;
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            Timer::Update();
+            pWindow->PollEvents();
+            ApplyPath(pRenderer, pathTime);
+
+            const uint64_t gpuFrame = pRenderer->GetFrameIndex();
+            pRenderer->Update();
+            pRenderer->Render();
+            const auto end = std::chrono::high_resolution_clock::now();
+
+            if (recorded)
+            {
+                // A frame that was skipped (e.g. swapchain out of date) never reaches the GPU
+                if (pRenderer->GetFrameIndex() != gpuFrame)
+                    pendingGpuFrames[gpuFrame] = m_vRecords.size();
+
+                // -- Memory is sampled outside of the timed part, the budget query goes to the driver --
+                constexpr double MEBIBYTE = 1024.0 * 1024.0;
+                std::vector<double> vMemoryMiB{};
+                for (const VkDeviceSize bytes : pRenderer->GetMemoryStats().taggedBytes)
+                    vMemoryMiB.push_back(static_cast<double>(bytes) / MEBIBYTE);
+                for (const MemoryAllocator::HeapStats& heapStats : pRenderer->GetHeapStats())
+                {
+                    vMemoryMiB.push_back(static_cast<double>(heapStats.usage) / MEBIBYTE);
+                    vMemoryMiB.push_back(static_cast<double>(heapStats.budget) / MEBIBYTE);
+                }
+
+                m_vRecords.push_back(
+                    {
+                        .caseIndex = caseIndex,
+                        .frame = frame - m_WarmupFrames,
+                        .cpuMilliseconds = std::chrono::duration<double, std::milli>(end - start).count(),
+                        .vGpuMilliseconds = std::vector<double>(m_vGpuScopes.size(), std::numeric_limits<double>::quiet_NaN()),
+                        .vMemoryMiB = std::move(vMemoryMiB)
+                    });
+            }
+            collectGpuTimings();
+        }
+    }
+
+    pRenderer->WaitIdle();
+    collectGpuTimings();
+
+    Timer::SetFixedDeltaSeconds(0.f);
+    pRenderer->SetInputEnabled(true);
+
+    WriteCSV();
+    WriteJSON();
+    std::cout << INFO_TXT << "[Benchmark] Results written to " << m_OutputPath << ".csv & " << m_OutputPath << ".json" << RESET_TXT << "\n";
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+void ashen::Benchmark::ParseScript(const std::string& scriptPath)
+{
+    std::ifstream file(scriptPath);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open benchmark script: " + scriptPath);
+
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        if (const auto comment = line.find('#'); comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream stream(line);
+        std::string command;
+        if (!(stream >> command))
+            continue;
+
+        // -- Every field has to be there, a short line would otherwise leave the rest zero --
+        const std::string location = scriptPath + ":" + std::to_string(lineNumber);
+        auto check = [&location, &command](const std::istream& extracted)
+        {
+            if (!extracted)
+                throw std::runtime_error("Failed to parse benchmark line " + location + ": malformed '" + command + "'!");
+        };
+        // Lists stop at the first value that does not parse, that has to be the end of the line
+        auto checkList = [&location, &command](const std::istream& extracted)
+        {
+            if (!extracted.eof())
+                throw std::runtime_error("Failed to parse benchmark line " + location + ": malformed '" + command + "'!");
+        };
+
+        if (command == "name")                  check(stream >> m_Name);
+        else if (command == "output")           check(stream >> m_OutputPath);
+        else if (command == "timestep")         check(stream >> m_TimeStep);
+        else if (command == "warmup")           check(stream >> m_WarmupFrames);
+        else if (command == "frames")           check(stream >> m_RecordedFrames);
+        else if (command == "camera")
+        {
+            CameraKey key{};
+            check(stream >> key.time
+                >> key.position.x >> key.position.y >> key.position.z
+                >> key.rotation.x >> key.rotation.y >> key.rotation.z);
+            m_vCameraKeys.push_back(key);
+        }
+        else if (command == "sun")
+        {
+            SunKey key{};
+            check(stream >> key.time >> key.direction.x >> key.direction.y >> key.direction.z);
+            m_vSunKeys.push_back(key);
+        }
+        else if (command == "samples")          { for (int v; stream >> v;) m_vSamples.push_back(v); checkList(stream); }
+        else if (command == "phase")            { for (uint32_t v; stream >> v;) m_vPhases.push_back(v); checkList(stream); }
+        else if (command == "kr")               { for (float v; stream >> v;) m_vKr.push_back(v); checkList(stream); }
+        else if (command == "km")               { for (float v; stream >> v;) m_vKm.push_back(v); checkList(stream); }
+        else if (command == "hdr")
+        {
+            for (std::string v; stream >> v;)
+                m_vHDR.push_back(v == "on" || v == "true" || v == "1");
+        }
+        else throw std::runtime_error(location + ": unknown command '" + command + "'");
+    }
+
+    if (m_TimeStep <= 0.f)
+        throw std::runtime_error(scriptPath + ": timestep must be positive");
+
+    auto byTime = [](const auto& a, const auto& b) { return a.time < b.time; };
+    std::ranges::stable_sort(m_vCameraKeys, byTime);
+    std::ranges::stable_sort(m_vSunKeys, byTime);
+}
+void ashen::Benchmark::BuildCases()
+{
+    // -- Unswept settings use the Renderer defaults --
+    const std::vector<int> vSamples         = m_vSamples.empty()    ? std::vector<int>{ 16 }            : m_vSamples;
+    const std::vector<uint32_t> vPhases     = m_vPhases.empty()     ? std::vector<uint32_t>{ 0 }        : m_vPhases;
+    const std::vector<bool> vHDR            = m_vHDR.empty()        ? std::vector<bool>{ true }         : m_vHDR;
+    const std::vector<float> vKr            = m_vKr.empty()         ? std::vector<float>{ 0.0025f }     : m_vKr;
+    const std::vector<float> vKm            = m_vKm.empty()         ? std::vector<float>{ 0.0010f }     : m_vKm;
+
+    // -- Cartesian product, HDR outermost so pipelines are rebuilt as rarely as possible --
+    m_vCases.clear();
+    for (const bool hdr : vHDR)
+        for (const int samples : vSamples)
+            for (const uint32_t phase : vPhases)
+                for (const float kr : vKr)
+                    for (const float km : vKm)
+                        m_vCases.push_back({ .samples = samples, .phase = phase, .hdr = hdr, .kr = kr, .km = km });
+}
+void ashen::Benchmark::ApplyPath(Renderer* pRenderer, float time) const
+{
+    // -- Linear interpolation between the surrounding keys, clamped at both ends --
+    auto sample = [time](const auto& vKeys, auto getValue)
+    {
+        if (time <= vKeys.front().time) return getValue(vKeys.front());
+        if (time >= vKeys.back().time)  return getValue(vKeys.back());
+
+        const auto next = std::ranges::upper_bound(vKeys, time, {}, [](const auto& key) { return key.time; });
+        const auto prev = next - 1;
+        const float alpha = (time - prev->time) / std::max(next->time - prev->time, 1e-6f);
+        return glm::mix(getValue(*prev), getValue(*next), alpha);
+    };
+
+    if (!m_vCameraKeys.empty())
+    {
+        Camera& camera = pRenderer->GetCamera();
+        camera.Position = sample(m_vCameraKeys, [](const CameraKey& key) { return key.position; });
+        camera.Rotation = sample(m_vCameraKeys, [](const CameraKey& key) { return key.rotation; });
+    }
+    if (!m_vSunKeys.empty())
+        pRenderer->SetLightDirection(sample(m_vSunKeys, [](const SunKey& key) { return key.direction; }));
+}
+void ashen::Benchmark::WriteCSV() const
+{
+    std::ofstream file(m_OutputPath + ".csv");
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open benchmark output: " + m_OutputPath + ".csv");
+
+    // The first GPU scope covers the whole frame, every other scope gets its own column
+    file << "case,samples,phase,hdr,kr,km,frame,cpu_ms,gpu_ms";
+    for (size_t scope{ 1 }; scope < m_vGpuScopes.size(); ++scope)
+        file << ",gpu_" << ScopeKey(m_vGpuScopes[scope]) << "_ms";
+    for (uint32_t tag{}; tag < MEMORY_TAG_COUNT; ++tag)
+        file << ",mem_" << ScopeKey(MemoryAllocator::GetTagName(static_cast<MemoryTag>(tag))) << "_mib";
+    for (uint32_t heap{}; heap < m_HeapCount; ++heap)
+        file << ",heap" << heap << "_usage_mib,heap" << heap << "_budget_mib";
+    file << "\n";
+
+    for (const FrameRecord& record : m_vRecords)
+    {
+        const Case& c = m_vCases[record.caseIndex];
+        file << record.caseIndex << "," << c.samples << "," << c.phase << "," << (c.hdr ? 1 : 0) << ","
+            << c.kr << "," << c.km << "," << record.frame << "," << record.cpuMilliseconds;
+        for (double ms : record.vGpuMilliseconds)
+        {
+            file << ",";
+            if (!std::isnan(ms))
+                file << ms;
+        }
+        for (double mib : record.vMemoryMiB)
+            file << "," << mib;
+        file << "\n";
+    }
+}
+void ashen::Benchmark::WriteJSON() const
+{
+    std::ofstream file(m_OutputPath + ".json");
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open benchmark output: " + m_OutputPath + ".json");
+
+    auto number = [](double value) { return std::isnan(value) ? std::string("null") : std::to_string(value); };
+
+    file << "{\n";
+    file << "  \"name\": \"" << EscapeJSON(m_Name) << "\",\n";
+    file << "  \"timestep\": " << m_TimeStep << ",\n";
+    file << "  \"warmup_frames\": " << m_WarmupFrames << ",\n";
+    file << "  \"recorded_frames\": " << m_RecordedFrames << ",\n";
+    file << "  \"cases\": [\n";
+    for (uint32_t caseIndex{}; caseIndex < static_cast<uint32_t>(m_vCases.size()); ++caseIndex)
+    {
+        const Case& c = m_vCases[caseIndex];
+
+        // -- Summary --
+        struct Summary
+        {
+            double sum{}, min{ std::numeric_limits<double>::max() }, max{};
+            uint32_t count{};
+
+            void Add(double value)
+            {
+                if (std::isnan(value)) return;
+                sum += value; ++count;
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+        };
+        Summary cpu{};
+        std::vector<Summary> vGpu(m_vGpuScopes.size());
+        for (const FrameRecord& record : m_vRecords)
+        {
+            if (record.caseIndex != caseIndex) continue;
+            cpu.Add(record.cpuMilliseconds);
+            for (size_t scope{}; scope < vGpu.size(); ++scope)
+                vGpu[scope].Add(record.vGpuMilliseconds[scope]);
+        }
+        auto summary = [&number](const Summary& s)
+        {
+            constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+            return "{ \"min\": " + number(s.count ? s.min : NaN) + ", \"avg\": " + number(s.count ? s.sum / s.count : NaN)
+                + ", \"max\": " + number(s.count ? s.max : NaN) + " }";
+        };
+
+        file << "    {\n";
+        file << "      \"samples\": " << c.samples << ", \"phase\": " << c.phase << ", \"hdr\": " << (c.hdr ? "true" : "false")
+            << ", \"kr\": " << c.kr << ", \"km\": " << c.km << ",\n";
+        file << "      \"cpu_ms\": " << summary(cpu) << ",\n";
+        if (!vGpu.empty())
+            file << "      \"gpu_ms\": " << summary(vGpu.front()) << ",\n";
+        file << "      \"gpu_passes_ms\": {";
+        for (size_t scope{ 1 }; scope < vGpu.size(); ++scope)
+            file << (scope == 1 ? "\n" : ",\n") << "        \"" << ScopeKey(m_vGpuScopes[scope]) << "\": " << summary(vGpu[scope]);
+        file << "\n      },\n";
+
+        // -- Frames --
+        file << "      \"frames\": [";
+        bool first = true;
+        for (const FrameRecord& record : m_vRecords)
+        {
+            if (record.caseIndex != caseIndex) continue;
+            file << (first ? "\n" : ",\n") << "        { \"frame\": " << record.frame
+                << ", \"cpu_ms\": " << number(record.cpuMilliseconds);
+            for (size_t scope{}; scope < record.vGpuMilliseconds.size(); ++scope)
+            {
+                file << ", \"gpu_" << (scope == 0 ? std::string{} : ScopeKey(m_vGpuScopes[scope]) + "_") << "ms\": "
+                    << number(record.vGpuMilliseconds[scope]);
+            }
+            file << " }";
+            first = false;
+        }
+        file << "\n      ]\n";
+        file << "    }" << (caseIndex + 1 < m_vCases.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+}
+std::string ashen::Benchmark::EscapeJSON(const std::string& value)
+{
+    // -- Quotes, backslashes & control characters are the only ones a JSON string can not hold as they are --
+    std::string escaped{};
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+            escaped += std::string{ '\\', c };
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            constexpr char HEX[] = "0123456789abcdef";
+            escaped += std::string{ "\\u00" } + HEX[(c >> 4) & 0xF] + HEX[c & 0xF];
+        }
+        else
+            escaped += c;
+    }
+    return escaped;
+}
+std::string ashen::Benchmark::ScopeKey(const std::string& scopeName)
+{
+    // -- "PostProcess" -> "postprocess", anything that is not alphanumeric becomes '_' --
+    std::string key{};
+    for (char c : scopeName)
+        key += std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : '_';
+    return key;
+}
@@ -0,0 +1,114 @@
+#ifndef ASHEN_BENCHMARK_H
+#define ASHEN_BENCHMARK_H
+
+// -- Standard Library --
+#include <string>
+#include <vector>
+
+// -- Math Includes --
+#include <glm/glm.hpp>
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class Renderer;
+	class Window;
+}
+
+namespace ashen
+{
+    //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~    Benchmark
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Runs a scripted, fixed-timestep camera path once for every combination of the swept settings.
+    // The CSV also samples GPU memory every recorded frame, per allocation tag and per heap.
+    // Script format, one command per line, '#' starts a comment:
+    //      name        <text>
+    //      timestep    <seconds>                               (default 1/60)
+    //      warmup      <frames>                                rendered but not recorded, per case
+    //      frames      <frames>                                recorded frames per case
+    //      output      <path without extension>                writes <path>.csv & <path>.json
+    //      camera      <time> <px> <py> <pz> <pitch> <yaw> <roll>
+    //      sun         <time> <dx> <dy> <dz>
+    //      samples     <count>...                              sweeps
+    //      phase       <index>...
+    //      hdr         <on|off>...
+    //      kr          <value>...
+    //      km          <value>...
+    class Benchmark final
+    {
+    public:
+        //--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+        explicit Benchmark(const std::string& scriptPath);
+
+        //--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+        void Run(Window* pWindow, Renderer* pRenderer);
+
+    private:
+        // -- Script --
+        struct CameraKey
+        {
+            float time;
+            glm::vec3 position;
+            glm::vec3 rotation;
+        };
+        struct SunKey
+        {
+            float time;
+            glm::vec3 direction;
+        };
+        struct Case
+        {
+            int samples;
+            uint32_t phase;
+            bool hdr;
+            float kr;
+            float km;
+        };
+        struct FrameRecord
+        {
+            uint32_t caseIndex;
+            uint32_t frame;
+            double cpuMilliseconds;
+            std::vector<double> vGpuMilliseconds;                  // Indexed by GPU scope, scope 0 is the whole frame
+            std::vector<double> vMemoryMiB;                        // Bytes per memory tag, followed by usage & budget per heap
+        };
+
+        std::string m_Name                  { "benchmark" };
+        std::string m_OutputPath            { "benchmark" };
+        float m_TimeStep                    { 1.f / 60.f };
+        uint32_t m_WarmupFrames             { 30 };
+        uint32_t m_RecordedFrames           { 300 };
+
+        std::vector<CameraKey> m_vCameraKeys{};
+        std::vector<SunKey> m_vSunKeys      {};
+        std::vector<int> m_vSamples         {};
+        std::vector<uint32_t> m_vPhases     {};
+        std::vector<bool> m_vHDR            {};
+        std::vector<float> m_vKr            {};
+        std::vector<float> m_vKm            {};
+
+        // -- Results --
+        std::vector<Case> m_vCases          {};
+        std::vector<FrameRecord> m_vRecords {};
+        std::vector<std::string> m_vGpuScopes{};
+        uint32_t m_HeapCount                {};
+
+        //--------------------------------------------------
+		//    Helpers
+		//--------------------------------------------------
+        void ParseScript(const std::string& scriptPath);
+        void BuildCases();
+        void ApplyPath(Renderer* pRenderer, float time) const;
+        void WriteCSV() const;
+        void WriteJSON() const;
+        static std::string ScopeKey(const std::string& scopeName);
+        static std::string EscapeJSON(const std::string& value);
+    };
+}
+
+#endif // ASHEN_BENCHMARK_H
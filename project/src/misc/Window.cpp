@@ -7,8 +7,14 @@
 //--------------------------------------------------
 //    Constructor & Destructor
 //--------------------------------------------------
-ashen::Window::Window(int width, int height, const std::string& title)
+ashen::Window::Window(int width, int height, const std::string& title, bool headless)
+    : m_IsHeadless(headless)
+    , m_HeadlessSize(width, height)
 {
+    // -- Headless windows never touch GLFW, so they work on machines without a display --
+    if (m_IsHeadless)
+        return;
+
     if (!glfwInit())
         throw std::runtime_error("Failed to initialize GLFW");
 
@@ -20,9 +26,17 @@ ashen::Window::Window(int width, int height, const std::string& title)
 
     glfwSetWindowUserPointer(m_pWindow, this);
     glfwSetFramebufferSizeCallback(m_pWindow, FrameBufferResizeCallback);
+
+    int w;
+    int h;
+    glfwGetFramebufferSize(m_pWindow, &w, &h);
+    m_FramebufferWidth = static_cast<uint32_t>(w);
+    m_FramebufferHeight = static_cast<uint32_t>(h);
 }
 ashen::Window::~Window()
 {
+    if (m_IsHeadless)
+        return;
     if (m_pWindow)
         glfwDestroyWindow(m_pWindow);
     glfwTerminate();
@@ -33,10 +47,16 @@ ashen::Window::~Window()
 //--------------------------------------------------
 bool ashen::Window::ShouldClose() const
 {
-    return glfwWindowShouldClose(m_pWindow);
+    if (m_IsHeadless) return m_ShouldClose;
+    return m_ShouldClose || glfwWindowShouldClose(m_pWindow);
+}
+void ashen::Window::Close()
+{
+    m_ShouldClose = true;
 }
 void ashen::Window::PollEvents() const
 {
+    if (m_IsHeadless) return;
     glfwPollEvents();
 }
 GLFWwindow* ashen::Window::GetGLFWwindow() const
@@ -45,17 +65,17 @@ GLFWwindow* ashen::Window::GetGLFWwindow() const
 }
 float ashen::Window::GetAspectRatio() const
 {
-    int w;
-    int h;
-    glfwGetFramebufferSize(m_pWindow, &w, &h);
-	return static_cast<float>(w) / static_cast<float>(h);
+    if (m_IsHeadless)
+        return static_cast<float>(m_HeadlessSize.x) / static_cast<float>(m_HeadlessSize.y);
+
+	return static_cast<float>(m_FramebufferWidth) / static_cast<float>(m_FramebufferHeight);
 }
 glm::uvec2 ashen::Window::GetFramebufferSize() const
 {
-    int w;
-    int h;
-    glfwGetFramebufferSize(m_pWindow, &w, &h);
-    return { w, h };
+    if (m_IsHeadless)
+        return m_HeadlessSize;
+
+    return { m_FramebufferWidth.load(), m_FramebufferHeight.load() };
 }
 
 //--------------------------------------------------
@@ -63,14 +83,18 @@ glm::uvec2 ashen::Window::GetFramebufferSize() const
 //--------------------------------------------------
 bool ashen::Window::IsKeyDown(int key) const
 {
+    if (m_IsHeadless) return false;
 	return glfwGetKey(m_pWindow, key) == GLFW_PRESS;
 }
 bool ashen::Window::IsMouseDown(int key) const
 {
+    if (m_IsHeadless) return false;
 	return glfwGetMouseButton(m_pWindow, key) == GLFW_PRESS;
 }
 glm::vec2 ashen::Window::GetCursorPos() const
 {
+    if (m_IsHeadless) return { 0.f, 0.f };
+
     double x;
     double y;
 	glfwGetCursorPos(m_pWindow, &x, &y);
@@ -81,6 +105,10 @@ glm::vec2 ashen::Window::GetCursorPos() const
 //--------------------------------------------------
 //    Misc
 //--------------------------------------------------
+bool ashen::Window::IsHeadless() const
+{
+    return m_IsHeadless;
+}
 bool ashen::Window::IsOutdated() const
 {
 	return m_IsOutdated;
@@ -89,8 +117,10 @@ void ashen::Window::ResetOutdated()
 {
     m_IsOutdated = false;
 }
-void ashen::Window::FrameBufferResizeCallback(GLFWwindow* window, int, int)
+void ashen::Window::FrameBufferResizeCallback(GLFWwindow* window, int width, int height)
 {
     Window* pWindow = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    pWindow->m_FramebufferWidth = static_cast<uint32_t>(width);
+    pWindow->m_FramebufferHeight = static_cast<uint32_t>(height);
     pWindow->m_IsOutdated = true;
 }
@@ -2,6 +2,7 @@
 #define ASHEN_WINDOW_H
 
 #include <GLFW/glfw3.h>
+#include <atomic>
 #include <string>
 #include "glm/vec2.hpp"
 
@@ -16,7 +17,7 @@ namespace ashen
         //--------------------------------------------------
 		//    Constructor & Destructor
 		//--------------------------------------------------
-        Window(int width, int height, const std::string& title);
+        Window(int width, int height, const std::string& title, bool headless = false);
         ~Window();
         Window(const Window& other) = delete;
         Window(Window&& other) = delete;
@@ -27,8 +28,10 @@ namespace ashen
 		//    Functionality
 		//--------------------------------------------------
         bool ShouldClose() const;
+        void Close();
         void PollEvents() const;
         GLFWwindow* GetGLFWwindow() const;
+        // Cached from the resize callback, unlike the rest of the window these are safe to call from any thread
         float GetAspectRatio() const;
         glm::uvec2 GetFramebufferSize() const;
 
@@ -36,13 +39,21 @@ namespace ashen
         bool IsMouseDown(int key) const;
         glm::vec2 GetCursorPos() const;
 
+        bool IsHeadless() const;
         bool IsOutdated() const;
         void ResetOutdated();
         static void FrameBufferResizeCallback(GLFWwindow* window, int width, int height);
 
     private:
         GLFWwindow* m_pWindow = nullptr;
-        bool m_IsOutdated = false;
+        std::atomic<bool> m_IsOutdated = false;
+        std::atomic<uint32_t> m_FramebufferWidth = 0;
+        std::atomic<uint32_t> m_FramebufferHeight = 0;
+
+        // -- Headless --
+        bool m_IsHeadless = false;
+        bool m_ShouldClose = false;
+        glm::uvec2 m_HeadlessSize{};
     };
 
 }
@@ -1,8 +1,10 @@
 // -- Ashen Includes --
 #include "Renderer.h"
 #include "Image.h"
+#include "MemoryAllocator.h"
 #include "Timer.h"
 #include "Types.h"
+#include "UploadManager.h"
 #include "ConsoleTextSettings.h"
 
 // -- Math Includes --
@@ -10,15 +12,25 @@
 #include "glm/gtx/norm.hpp"
 
 // -- Standard Library --
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 //--------------------------------------------------
 //    Constructor & Destructor
 //--------------------------------------------------
-ashen::Renderer::Renderer(Window* pWindow)
+ashen::Renderer::Renderer(Window* pWindow, const RendererSettings& settings)
 	: m_pWindow(pWindow)
-	, m_pContext(std::make_unique<VulkanContext>(pWindow))
+	, m_pContext(std::make_unique<VulkanContext>(pWindow, std::clamp(settings.framesInFlight, 1u, RendererSettings::MAX_FRAMES_IN_FLIGHT)))
+	, m_Settings(settings)
+	, m_RenderGraph(*m_pContext)
 {
+    m_Settings.framesInFlight = std::clamp(m_Settings.framesInFlight, 1u, RendererSettings::MAX_FRAMES_IN_FLIGHT);
+    m_vFrames.resize(m_Settings.framesInFlight);
+
     // -- Camera --
     m_pCamera = std::make_unique<Camera>(pWindow);
     m_pCamera->Position.y = m_InnerRadius + (m_OuterRadius - m_InnerRadius) * 0.01f;
@@ -40,26 +52,63 @@ ashen::Renderer::Renderer(Window* pWindow)
     // -- Render --
 	CreateSyncObjects();
 
-    m_pMeshFloor    = CreateDome(m_InnerRadius, 250, 250);
-    m_pMeshSky      = CreateDome(m_OuterRadius, 250, 250);
+    m_pGpuProfiler      = std::make_unique<GpuProfiler>(*m_pContext, m_Settings.framesInFlight);
+    m_ScopeFrame        = m_pGpuProfiler->RegisterScope("Frame");
+    m_ScopeGround       = m_pGpuProfiler->RegisterScope("Ground", true);
+    m_ScopeSky          = m_pGpuProfiler->RegisterScope("Sky", true);
+    m_ScopePostProcess  = m_pGpuProfiler->RegisterScope("PostProcess", true);
 
-    const auto count = m_pContext->GetSwapchainImageCount();
-    m_vUBOSpace_VS  = { *m_pContext, count };
-    m_vUBOSpace_FS  = { *m_pContext, count };
+    // -- Domes --
+    SetDomeLodPixelError(m_Settings.domeLodPixelError);
+    if (m_Settings.domeLod)
+        m_pDomeLod = std::make_unique<DomeLod>(*m_pContext);
 
-    m_vUBOGround_VS = { *m_pContext, count };
-    m_vUBOGround_FS = { *m_pContext, count };
+    m_ProceduralDomes = !m_pDomeLod && m_Settings.vertexLayout == VertexLayout::Procedural;
+    if (m_ProceduralDomes)
+    {
+        glm::vec4 zeroVertex{};
+        BufferAllocator bufferAlloc{ *m_pContext };
+        bufferAlloc
+            .SetSize(sizeof(zeroVertex))
+            .HostAccess(false)
+            .SetMemoryTag(MemoryTag::Mesh)
+            .SetUsage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+            .AddInitialData(&zeroVertex, 0, static_cast<uint32_t>(sizeof(zeroVertex)))
+            .Allocate(m_DomeVertexSource);
+    }
+    else if (!m_pDomeLod)
+    {
+        m_pMeshDome = CreateDome(1.f, static_cast<int>(m_DomeSegments), static_cast<int>(m_DomeSegments));
+    }
 
-    m_vUBOSky_VS    = { *m_pContext, count };
-    m_vUBOSky_FS    = { *m_pContext, count };
+    CreateUniformBuffers();
 
     CreateSamplers();
-    CreateDepthResources(m_pContext->GetSwapchainExtent());
-    CreateRenderTargets(m_pContext->GetSwapchainExtent());
+    m_HDRFormat = m_Settings.hdrFormat;
+    m_ActiveHDRFormat = m_HDRFormat;
+    m_HDRTargetFormat = ResolveHDRFormat(m_ActiveHDRFormat);
+    m_PendingHDRTargetFormat = m_HDRTargetFormat;
+    m_DepthFormat = Image::FindSupportedFormat(m_pContext->GetPhysicalDevice(),
+        { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+        VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    m_pAttachments = std::make_unique<AttachmentPool>(*m_pContext, m_Settings.framesInFlight);
     CreateDescriptorSets();
 
-    CreatePipelines(m_UseHDR ? m_vRenderTargets.front().GetFormat() : m_pContext->GetSwapchainFormat());
+    m_ActiveHDR = m_UseHDR;
+    m_pBackgroundThreads = std::make_unique<ThreadPool>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    m_pPipelines = std::make_unique<PipelineRegistry>(*m_pBackgroundThreads);
+    RegisterPipelines(m_HDRTargetFormat);
+    RegisterPipelines(m_pContext->GetSwapchainFormat());
     CreateCommandBuffers();
+
+    if (m_Settings.recordingThreads > 0)
+    {
+        m_pRecordingThreads = std::make_unique<ThreadPool>(m_Settings.recordingThreads);
+        m_pCommandRecorder  = std::make_unique<SecondaryCommandRecorder>(*m_pContext, *m_pRecordingThreads, m_Settings.framesInFlight);
+    }
+
+    // The render side always has a snapshot to start from, even before the first update
+    PublishSnapshot();
 }
 ashen::Renderer::~Renderer()
 {
@@ -67,10 +116,11 @@ ashen::Renderer::~Renderer()
     vkDeviceWaitIdle(device);
 
     vkDestroySampler(m_pContext->GetDevice(), m_PostProcessSampler, nullptr);
+    m_pCommandRecorder.reset();
+    m_pRecordingThreads.reset();
+    m_pGpuProfiler.reset();
 
-	for (const auto& sem : m_vImageAvailableSemaphores) vkDestroySemaphore(device, sem, nullptr);
-	for (const auto& sem : m_vRenderFinishedSemaphores) vkDestroySemaphore(device, sem, nullptr);
-	for (const auto& fence : m_vInFlightFences) vkDestroyFence(device, fence, nullptr);
+    DestroySyncObjects();
 }
 
 
@@ -79,8 +129,169 @@ ashen::Renderer::~Renderer()
 //--------------------------------------------------
 void ashen::Renderer::Update()
 {
-    HandleInput();
+    if (m_InputEnabled)
+        HandleInput();
+
+    // A minimized window has no size, the camera keeps the last valid aspect ratio meanwhile
+    const glm::uvec2 size = m_pWindow->GetFramebufferSize();
+    if (size.x != 0 && size.y != 0)
+        m_pCamera->AspectRatio = m_pWindow->GetAspectRatio();
+
+    PublishSnapshot();
+}
+void ashen::Renderer::Render()
+{
+    // -- Latest parameters of the update side, the previous snapshot is rendered again if nothing new was published --
+    m_Snapshots.Consume();
+    const FrameSnapshot& snapshot = m_Snapshots.GetReadBuffer();
+    m_ActiveHDR = snapshot.useHDR;
+    if (snapshot.hdrFormat != m_ActiveHDRFormat)
+        ChangeHDRFormat(snapshot.hdrFormat);
+
+    // -- Fast linked pipelines are replaced by their optimized link as those finish in the background --
+    m_pPipelines->Update();
+    ApplyPendingHDRFormat();
+
+    if (m_pContext->IsHeadless())
+    {
+        RenderHeadless(snapshot);
+        return;
+    }
+
+    VkDevice device = m_pContext->GetDevice();
+    VkSwapchainKHR swapchain = m_pContext->GetSwapchain();
+
+    FrameResources& frame = m_vFrames[m_CurrentFrame];
+    WaitForFrame();
+    WriteUniforms(snapshot);
+
+    uint32_t imageIndex;
+    auto result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+    {
+        OnResize();
+    	return;
+    }
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("Failed to acquire Swap Chain Image");
+
+    vkResetFences(device, 1, &frame.inFlight);
+
+	RecordCommandBuffer(imageIndex, snapshot);
+
+    // -- Uploads recorded since the last frame go out as one batch, the frame only waits on them where vertices are read --
+    UploadManager& uploads = m_pContext->GetUploadManager();
+    const uint64_t uploadValue = uploads.Flush();
+
+    VkSemaphore waitSemaphores[] = { frame.imageAvailable, uploads.GetTimelineSemaphore() };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT };
+    const uint64_t waitValues[] = { 0, uploadValue };
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = 2;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = 2;
+    submitInfo.pWaitSemaphores = waitSemaphores;
+    submitInfo.pWaitDstStageMask = waitStages;
+
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &frame.commandBuffer;
+
+    VkSemaphore signalSemaphores[] = { m_vRenderFinishedSemaphores[imageIndex] };
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+
+    std::unique_lock queueLock{ m_pContext->GetQueueMutex() };
+    vkQueueSubmit(m_pContext->GetQueue(vkb::QueueType::graphics), 1, &submitInfo, frame.inFlight);
 
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapchain;
+    presentInfo.pImageIndices = &imageIndex;
+    
+    result = vkQueuePresentKHR(m_pContext->GetQueue(vkb::QueueType::present), &presentInfo);
+    queueLock.unlock();
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_pWindow->IsOutdated())
+    {
+        m_pWindow->ResetOutdated();
+        OnResize();
+    }
+    else if (result != VK_SUCCESS)
+        throw std::runtime_error("Failed to present Swap Chain Image!");
+
+    ++m_PresentedFrames;
+    m_CurrentFrame = (m_CurrentFrame + 1) % m_Settings.framesInFlight;
+}
+void ashen::Renderer::RenderHeadless(const FrameSnapshot& snapshot)
+{
+    // -- No swapchain to acquire from or present to, the offscreen targets are cycled in order instead --
+    FrameResources& frame = m_vFrames[m_CurrentFrame];
+    WaitForFrame();
+    WriteUniforms(snapshot);
+    vkResetFences(m_pContext->GetDevice(), 1, &frame.inFlight);
+
+    const uint32_t imageIndex = m_OffscreenImageIndex;
+    m_OffscreenImageIndex = (m_OffscreenImageIndex + 1) % m_pContext->GetSwapchainImageCount();
+
+    RecordCommandBuffer(imageIndex, snapshot);
+
+    UploadManager& uploads = m_pContext->GetUploadManager();
+    const uint64_t uploadValue = uploads.Flush();
+    VkSemaphore waitSemaphore = uploads.GetTimelineSemaphore();
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = 1;
+    timelineInfo.pWaitSemaphoreValues = &uploadValue;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &waitSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &frame.commandBuffer;
+
+    {
+        std::lock_guard queueLock{ m_pContext->GetQueueMutex() };
+        vkQueueSubmit(m_pContext->GetQueue(vkb::QueueType::graphics), 1, &submitInfo, frame.inFlight);
+    }
+
+    ++m_PresentedFrames;
+    m_CurrentFrame = (m_CurrentFrame + 1) % m_Settings.framesInFlight;
+}
+void ashen::Renderer::WaitIdle()
+{
+    {
+        std::lock_guard queueLock{ m_pContext->GetQueueMutex() };
+        vkDeviceWaitIdle(m_pContext->GetDevice());
+    }
+    for (uint32_t frame{}; frame < m_Settings.framesInFlight; ++frame)
+        m_pGpuProfiler->Resolve(frame);
+}
+void ashen::Renderer::WaitForFrame()
+{
+    // -- The frame's previous submission has to be done before its command buffer or uniforms are touched again --
+    vkWaitForFences(m_pContext->GetDevice(), 1, &m_vFrames[m_CurrentFrame].inFlight, VK_TRUE, UINT64_MAX);
+    m_pGpuProfiler->Resolve(m_CurrentFrame);
+}
+
+
+//--------------------------------------------------
+//    Snapshot
+//--------------------------------------------------
+void ashen::Renderer::PublishSnapshot()
+{
     SkyVS skyVs
     {
         .cameraPos = m_pCamera->Position,
@@ -114,8 +325,6 @@ void ashen::Renderer::Update()
         .g2 = m_g * m_g,
         .phaseType = m_PhaseFunctionIndex
     };
-    m_vUBOSky_VS[m_CurrentFrame].MapData(&skyVs, sizeof(SkyVS));
-    m_vUBOSky_FS[m_CurrentFrame].MapData(&skyFs, sizeof(SkyFS));
 
 
 
@@ -149,8 +358,6 @@ void ashen::Renderer::Update()
     {
         .n = 0.f
     };
-    m_vUBOGround_VS[m_CurrentFrame].MapData(&groundVs, sizeof(GroundVS));
-    m_vUBOGround_FS[m_CurrentFrame].MapData(&groundFs, sizeof(GroundFS));
 
 
 
@@ -162,66 +369,146 @@ void ashen::Renderer::Update()
     {
         .eT = Timer::GetTotalTimeSeconds()
     };
-    m_vUBOSpace_VS[m_CurrentFrame].MapData(&spaceVs, sizeof(SpaceVS));
-    m_vUBOSpace_FS[m_CurrentFrame].MapData(&spaceFx, sizeof(SpaceFS));
+
+    // -- Publish --
+    FrameSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+    snapshot.skyVS = skyVs;
+    snapshot.skyFS = skyFs;
+    snapshot.groundVS = groundVs;
+    snapshot.groundFS = groundFs;
+    snapshot.spaceVS = spaceVs;
+    snapshot.spaceFS = spaceFx;
+
+    snapshot.cameraMatrices = { m_pCamera->GetProjectionMatrix() * m_pCamera->GetViewMatrix() };
+    snapshot.cameraHeight = glm::length(m_pCamera->Position);
+    snapshot.exposure = m_Exposure;
+    snapshot.useHDR = m_UseHDR;
+    snapshot.hdrFormat = m_HDRFormat;
+    snapshot.domeSegments = m_DomeSegments;
+
+    // -- Dome LOD, both domes are refined for this snapshot's camera, only the planet hides the ground behind its horizon --
+    if (m_pDomeLod)
+    {
+        const DomeLod::View view
+        {
+            .cameraPos = m_pCamera->Position,
+            .viewProj = snapshot.cameraMatrices.viewProj,
+            .pixelsPerRadian = static_cast<float>(m_pWindow->GetFramebufferSize().y) / (2.f * std::tan(glm::radians(m_pCamera->Fov) * 0.5f))
+        };
+        m_pDomeLod->Select(view, m_InnerRadius, m_DomeLodPixelError, true, snapshot.groundPatches);
+        m_pDomeLod->Select(view, m_OuterRadius, m_DomeLodPixelError, false, snapshot.skyPatches);
+        m_DomePatchCounts = { static_cast<uint32_t>(snapshot.groundPatches.size()), static_cast<uint32_t>(snapshot.skyPatches.size()) };
+    }
+    m_Snapshots.Publish();
 }
-void ashen::Renderer::Render()
+void ashen::Renderer::WriteUniforms(const FrameSnapshot& snapshot)
 {
-    VkDevice device = m_pContext->GetDevice();
-    VkSwapchainKHR swapchain = m_pContext->GetSwapchain();
-
-    vkWaitForFences(device, 1, &m_vInFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
-
-    uint32_t imageIndex;
-    auto result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, m_vImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE, &imageIndex);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+    FrameResources& frame = m_vFrames[m_CurrentFrame];
+    m_pUniformRing->BeginFrame(m_CurrentFrame);
+    frame.uniformOffsetsSky = { m_pUniformRing->Push(snapshot.skyVS), m_pUniformRing->Push(snapshot.skyFS) };
+    frame.uniformOffsetsGround = { m_pUniformRing->Push(snapshot.groundVS), m_pUniformRing->Push(snapshot.groundFS) };
+    frame.uniformOffsetsSpace = { m_pUniformRing->Push(snapshot.spaceVS), m_pUniformRing->Push(snapshot.spaceFS) };
+
+    // -- Dome patches are streamed as instance data, a dome without visible patches draws nothing --
+    if (m_pPatchRing)
     {
-        OnResize();
-    	return;
+        m_pPatchRing->BeginFrame(m_CurrentFrame);
+        auto pushPatches = [this](const std::vector<DomeLod::Patch>& vPatches)
+        {
+            return vPatches.empty() ? 0u : m_pPatchRing->Push(vPatches.data(), vPatches.size() * sizeof(DomeLod::Patch));
+        };
+        frame.patchOffsetGround = pushPatches(snapshot.groundPatches);
+        frame.patchOffsetSky = pushPatches(snapshot.skyPatches);
     }
-    if (result != VK_SUCCESS)
-        throw std::runtime_error("Failed to acquire Swap Chain Image");
-
-    vkResetFences(device, 1, &m_vInFlightFences[m_CurrentFrame]);
-
-	RecordCommandBuffer(imageIndex);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-    VkSemaphore waitSemaphores[] = { m_vImageAvailableSemaphores[m_CurrentFrame] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+}
 
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &m_vCommandBuffers[m_CurrentFrame];
 
-    VkSemaphore signalSemaphores[] = { m_vRenderFinishedSemaphores[m_CurrentFrame] };
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-
-    vkQueueSubmit(m_pContext->GetQueue(vkb::QueueType::graphics), 1, &submitInfo, m_vInFlightFences[m_CurrentFrame]);
+//--------------------------------------------------
+//    Settings
+//--------------------------------------------------
+ashen::Camera& ashen::Renderer::GetCamera() const
+{
+    return *m_pCamera;
+}
+void ashen::Renderer::SetInputEnabled(bool enabled)
+{
+    m_InputEnabled = enabled;
+}
+void ashen::Renderer::SetSampleCount(int count)
+{
+    m_SampleCount = std::max(1, count);
+}
+void ashen::Renderer::SetPhaseFunction(uint32_t index)
+{
+    m_PhaseFunctionIndex = index % m_PhaseFunctionCount;
+}
+void ashen::Renderer::SetHDR(bool enabled)
+{
+    // The pipelines follow on the render side once the snapshot arrives
+    m_UseHDR = enabled;
+}
+void ashen::Renderer::SetHDRFormat(HDRFormat format)
+{
+    // The targets are recreated on the render side once the snapshot arrives
+    m_HDRFormat = format;
+}
+void ashen::Renderer::SetDomeSegments(uint32_t segments)
+{
+    // Nothing to rebuild, the next snapshot draws the domes with the new resolution
+    if (m_ProceduralDomes)
+        m_DomeSegments = std::clamp(segments, 10u, 1000u);
+}
+void ashen::Renderer::SetDomeLodPixelError(float pixels)
+{
+    // The next snapshot refines the domes to the new error
+    m_DomeLodPixelError = std::clamp(pixels, 1.f, 64.f);
+}
+void ashen::Renderer::SetRayleigh(float kr)
+{
+    m_Kr = kr;
+    m_Kr4PI = m_Kr * 4.0f * std::numbers::pi_v<float>;
+}
+void ashen::Renderer::SetMie(float km)
+{
+    m_Km = km;
+    m_Km4PI = m_Km * 4.0f * std::numbers::pi_v<float>;
+}
+void ashen::Renderer::SetLightDirection(const glm::vec3& direction)
+{
+    m_LightDirection = glm::normalize(direction);
+}
 
-    VkPresentInfoKHR presentInfo{};
-    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
-    presentInfo.swapchainCount = 1;
-    presentInfo.pSwapchains = &swapchain;
-    presentInfo.pImageIndices = &imageIndex;
-    
-    result = vkQueuePresentKHR(m_pContext->GetQueue(vkb::QueueType::present), &presentInfo);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_pWindow->IsOutdated())
-    {
-        m_pWindow->ResetOutdated();
-        OnResize();
-    }
-    else if (result != VK_SUCCESS)
-        throw std::runtime_error("Failed to present Swap Chain Image!");
 
-    m_CurrentFrame = (m_CurrentFrame + 1) % m_vInFlightFences.size();
+//--------------------------------------------------
+//    Statistics
+//--------------------------------------------------
+uint64_t ashen::Renderer::GetFrameIndex() const
+{
+    return m_FrameIndex;
+}
+uint32_t ashen::Renderer::GetFramesInFlight() const
+{
+    return m_Settings.framesInFlight;
+}
+std::vector<ashen::GpuFrameTiming> ashen::Renderer::ConsumeGpuTimings()
+{
+    return m_pGpuProfiler->ConsumeTimings();
+}
+const std::vector<std::string>& ashen::Renderer::GetGpuScopeNames() const
+{
+    return m_pGpuProfiler->GetScopeNames();
+}
+std::vector<ashen::GpuProfiler::ScopeStats> ashen::Renderer::GetGpuStats() const
+{
+    return m_pGpuProfiler->GetStats();
+}
+ashen::MemoryAllocator::Stats ashen::Renderer::GetMemoryStats() const
+{
+    return m_pContext->GetMemoryAllocator().GetStats();
+}
+std::vector<ashen::MemoryAllocator::HeapStats> ashen::Renderer::GetHeapStats() const
+{
+    return m_pContext->GetMemoryAllocator().GetHeapStats();
 }
 void ashen::Renderer::HandleInput()
 {
@@ -254,12 +541,15 @@ void ashen::Renderer::HandleInput()
     static bool tabPrev = false;
     const bool tabCurr = m_pWindow->IsKeyDown(GLFW_KEY_TAB);
     if (tabCurr && !tabPrev)
-    {
         m_UseHDR = !m_UseHDR;
-        CreatePipelines(m_UseHDR ? m_vRenderTargets.front().GetFormat() : m_pContext->GetSwapchainFormat());
-    }
     tabPrev = tabCurr;
 
+    static bool rPrev = false;
+    const bool rCurr = m_pWindow->IsKeyDown(GLFW_KEY_R);
+    if (rCurr && !rPrev)
+        m_HDRFormat = static_cast<HDRFormat>((static_cast<uint32_t>(m_HDRFormat) + 1) % 3);
+    rPrev = rCurr;
+
     // -- Scattering --
     if (m_pWindow->IsKeyDown(GLFW_KEY_1))
     {
@@ -365,6 +655,23 @@ void ashen::Renderer::HandleInput()
         else m_kOzoneExt += koeChange;
     }
 
+    // -- Dome Resolution, the meshes are only built once so only procedural domes change, LOD domes change their pixel error instead --
+    static bool lPrev = false;
+    const bool lCurr = m_pWindow->IsKeyDown(GLFW_KEY_L);
+    if (lCurr && !lPrev && m_pDomeLod)
+    {
+        constexpr float errorChange = 2.f;
+        if (m_pWindow->IsKeyDown(GLFW_KEY_LEFT_SHIFT)) SetDomeLodPixelError(m_DomeLodPixelError - errorChange);
+        else SetDomeLodPixelError(m_DomeLodPixelError + errorChange);
+    }
+    else if (lCurr && !lPrev)
+    {
+        constexpr uint32_t segmentChange = 50u;
+        if (m_pWindow->IsKeyDown(GLFW_KEY_LEFT_SHIFT)) SetDomeSegments(m_DomeSegments > segmentChange ? m_DomeSegments - segmentChange : 0u);
+        else SetDomeSegments(m_DomeSegments + segmentChange);
+    }
+    lPrev = lCurr;
+
     // -- Phase Function --
     static bool fPrev = false;
     const bool fCurr = m_pWindow->IsKeyDown(GLFW_KEY_F);
@@ -378,26 +685,21 @@ void ashen::Renderer::HandleInput()
 void ashen::Renderer::PrintStats()
 {
     // -- FPS calculation over 1 second --
+    // Frames are counted where they are submitted, the update side this runs on may tick at another rate
     static float elapsedTime = 0.f;
-    static int frames = 0;
     static float fps = 0.f;
 
     elapsedTime += Timer::GetDeltaSeconds();
-    frames++;
-
     if (elapsedTime >= 1.0f)
     {
-        fps = static_cast<float>(frames) / elapsedTime;
-        frames = 0;
+        fps = static_cast<float>(m_PresentedFrames.exchange(0)) / elapsedTime;
         elapsedTime = 0.f;
     }
 
 
     // -- Move cursor up to overwrite previous stats --
-    static bool first = true;
-    if (!first)
-        std::cout << "\033[15A";
-	first = false;
+    if (m_PrintedStatLines != 0)
+        std::cout << "\033[" << m_PrintedStatLines << "A";
 
     // -- Print stats with keybind hints --
     std::cout << "--- STATS OVERVIEW ---\n";
@@ -425,6 +727,20 @@ void ashen::Renderer::PrintStats()
     std::cout << CLEAR_LINE << BRIGHT_BLACK_TXT << "[Tab]" << RESET_TXT
 				<< "\t\t\t\tHDR: " << (m_UseHDR ? BRIGHT_GREEN_TX : BRIGHT_RED_TXT) << (m_UseHDR ? "True" : "False") << RESET_TXT << "\n";
 
+    // -- HDR target traffic, every pixel is written by the ground, read & written by the sky blend and read by the post process --
+    // An estimate assuming both passes cover the screen, caches & framebuffer compression only ever make it lower
+    const VkFormat hdrTargetFormat = m_HDRTargetFormat;
+    std::string hdrFormatName = "Unknown";
+    if (hdrTargetFormat == VK_FORMAT_B10G11R11_UFLOAT_PACK32) hdrFormatName = "B10G11R11";
+    if (hdrTargetFormat == VK_FORMAT_R16G16B16A16_SFLOAT) hdrFormatName = "RGBA16F";
+    if (hdrTargetFormat == VK_FORMAT_R32G32B32A32_SFLOAT) hdrFormatName = "RGBA32F";
+    const glm::uvec2 targetSize = m_pWindow->GetFramebufferSize();
+    const float targetMiB = 4.f * static_cast<float>(targetSize.x) * static_cast<float>(targetSize.y)
+        * static_cast<float>(Image::GetTexelSize(hdrTargetFormat)) / (1024.f * 1024.f);
+    std::cout << CLEAR_LINE << BRIGHT_BLACK_TXT << "[R]" << RESET_TXT
+				<< "\t\t\t\tHDR Format: " << DARK_CYAN_TXT << hdrFormatName << RESET_TXT
+				<< "  ~" << (m_UseHDR ? targetMiB : 0.f) << " MiB/frame, " << (m_UseHDR ? targetMiB * fps / 1024.f : 0.f) << " GiB/s\n";
+
     std::cout << CLEAR_LINE << BRIGHT_BLACK_TXT << "[Key 8 / Shift + 8]" << RESET_TXT
         << "\t\tExposure: " << m_Exposure << "\n";
 
@@ -447,11 +763,103 @@ void ashen::Renderer::PrintStats()
     std::cout << CLEAR_LINE << BRIGHT_BLACK_TXT << "[Key 9 / Shift + 9]" << RESET_TXT
         << "\t\tLight Preset: " << m_LightIndex << "\n";
 
+    if (m_pDomeLod)
+    {
+        std::cout << CLEAR_LINE << BRIGHT_BLACK_TXT << "[Key L / Shift + L]" << RESET_TXT
+            << "\t\tDome LOD: " << m_DomeLodPixelError << " px error  Patches: " << DARK_YELLOW_TXT << m_DomePatchCounts.x << RESET_TXT << " ground, "
+            << DARK_YELLOW_TXT << m_DomePatchCounts.y << RESET_TXT << " sky  (" << m_pDomeLod->GetVerticesPerPatch() << " vertices each)\n";
+    }
+    else
+    {
+        std::cout << CLEAR_LINE << BRIGHT_BLACK_TXT << "[Key L / Shift + L]" << RESET_TXT
+            << "\t\tDome Segments: " << m_DomeSegments << (m_ProceduralDomes ? " (procedural)" : " (mesh)") << "\n";
+    }
+
+    // -- Simulated post-transform cache misses of the dome, per triangle (ACMR) & per vertex (ATVR), as generated -> as drawn --
+    std::cout << CLEAR_LINE << "Dome Vertex Cache:\t\t";
+    if (m_pMeshDome)
+    {
+        const MeshOptimizer::CacheStats& before = m_pMeshDome->GetCacheStatsBefore();
+        const MeshOptimizer::CacheStats& after = m_pMeshDome->GetCacheStatsAfter();
+        std::cout << "ACMR " << before.acmr << " -> " << DARK_YELLOW_TXT << after.acmr << RESET_TXT
+            << "  ATVR " << before.atvr << " -> " << DARK_YELLOW_TXT << after.atvr << RESET_TXT
+            << "  Indices: " << DARK_CYAN_TXT << (m_pMeshDome->GetIndexType() == VK_INDEX_TYPE_UINT16 ? "16" : "32") << " bit" << RESET_TXT
+            << " in " << m_pMeshDome->GetIndexChunkCount() << " draw(s)\n";
+    }
+    else if (m_pDomeLod)
+    {
+        const MeshOptimizer::CacheStats& before = m_pDomeLod->GetCacheStatsBefore();
+        const MeshOptimizer::CacheStats& after = m_pDomeLod->GetCacheStatsAfter();
+        std::cout << "ACMR " << before.acmr << " -> " << DARK_YELLOW_TXT << after.acmr << RESET_TXT
+            << "  ATVR " << before.atvr << " -> " << DARK_YELLOW_TXT << after.atvr << RESET_TXT
+            << "  Indices: " << DARK_CYAN_TXT << "16 bit" << RESET_TXT << " patch grid, 1 instanced draw per dome\n";
+    }
+    else
+        std::cout << "No mesh, procedural\n";
+
     std::cout << CLEAR_LINE << BRIGHT_BLACK_TXT << "[X]" << RESET_TXT
 				<< "\t\t\t\tFPS: " << DARK_YELLOW_TXT << fps  << RESET_TXT << "\n";
 
+    // -- GPU pass timings, last (min / avg / max) over the rolling window --
+    // Followed by the workload of the pass: primitives in -> surviving clipping, vertex & fragment invocations
+    uint32_t gpuLines{};
+    for (const auto& stats : m_pGpuProfiler->GetStats())
+    {
+        std::cout << CLEAR_LINE << "GPU " << stats.name << ":\t\t\t"
+            << DARK_YELLOW_TXT << stats.lastMs << "ms" << RESET_TXT
+            << " (" << stats.minMs << " / " << stats.avgMs << " / " << stats.maxMs << ")\n";
+        ++gpuLines;
+
+        if (!stats.hasStatistics)
+            continue;
+        const PipelineStatistics& pipelineStats = stats.statistics;
+        std::cout << CLEAR_LINE << "\t\t\t\tPrims: " << pipelineStats.inputAssemblyPrimitives
+            << " -> " << pipelineStats.clippingPrimitives
+            << "  VS: " << DARK_CYAN_TXT << pipelineStats.vertexShaderInvocations << RESET_TXT
+            << "  FS: " << DARK_CYAN_TXT << pipelineStats.fragmentShaderInvocations << RESET_TXT << "\n";
+        ++gpuLines;
+    }
+
+    // -- GPU memory, used out of what is reserved in blocks & dedicated allocations --
+    constexpr float MEBIBYTE = 1024.f * 1024.f;
+    const MemoryAllocator::Stats memoryStats = m_pContext->GetMemoryAllocator().GetStats();
+    std::cout << CLEAR_LINE << "GPU Memory:\t\t\t"
+        << DARK_YELLOW_TXT << static_cast<float>(memoryStats.usedBytes) / MEBIBYTE << RESET_TXT
+        << " / " << static_cast<float>(memoryStats.reservedBytes) / MEBIBYTE << " MiB"
+        << "  Blocks: " << memoryStats.blockCount << " (+" << memoryStats.dedicatedCount << " dedicated)"
+        << "  Fragmentation: " << DARK_CYAN_TXT << memoryStats.fragmentation * 100.f << "%" << RESET_TXT << "\n";
+
+    // -- Per heap, what the process uses out of what the OS allows it, and how much of that went through the allocator --
+    // A total that keeps growing while nothing changes on screen is a leak, resizing should always return to the same numbers
+    const std::vector<MemoryAllocator::HeapStats> vHeapStats = m_pContext->GetMemoryAllocator().GetHeapStats();
+    for (uint32_t heap{}; heap < vHeapStats.size(); ++heap)
+    {
+        const MemoryAllocator::HeapStats& heapStats = vHeapStats[heap];
+        const bool overBudget = heapStats.usage > heapStats.budget;
+        std::cout << CLEAR_LINE << "Heap " << heap << (heapStats.deviceLocal ? " Device:" : " Host:") << "\t\t\t"
+            << (overBudget ? BRIGHT_RED_TXT : DARK_YELLOW_TXT) << static_cast<float>(heapStats.usage) / MEBIBYTE << RESET_TXT
+            << " / " << static_cast<float>(heapStats.budget) / MEBIBYTE << " MiB budget"
+            << "  Ashen: " << static_cast<float>(heapStats.allocatedBytes) / MEBIBYTE << " MiB\n";
+    }
+
+    std::cout << CLEAR_LINE << "Memory Tags:\t\t\t";
+    for (uint32_t tag{}; tag < MEMORY_TAG_COUNT; ++tag)
+    {
+        std::cout << MemoryAllocator::GetTagName(static_cast<MemoryTag>(tag)) << ": "
+            << DARK_CYAN_TXT << static_cast<float>(memoryStats.taggedBytes[tag]) / MEBIBYTE << RESET_TXT << "  ";
+    }
+    std::cout << "MiB\n";
+
+    // -- Initial data that went through the staging ring, and what host visible device memory let skip it --
+    const UploadManager::Stats uploadStats = m_pContext->GetUploadManager().GetStats();
+    std::cout << CLEAR_LINE << "Uploads:\t\t\t"
+        << DARK_YELLOW_TXT << static_cast<float>(uploadStats.stagedBytes) / MEBIBYTE << RESET_TXT << " MiB staged in " << uploadStats.batchCount << " batches"
+        << "  Direct: " << DARK_CYAN_TXT << static_cast<float>(uploadStats.directBytes) / MEBIBYTE << " MiB" << RESET_TXT << " not staged\n";
+
     std::cout << "--- STATS OVERVIEW ---\n";
     std::cout << std::flush;
+
+    m_PrintedStatLines = 21 + gpuLines + static_cast<uint32_t>(vHeapStats.size());
 }
 
 
@@ -462,9 +870,6 @@ void ashen::Renderer::PrintStats()
 std::unique_ptr<ashen::Mesh> ashen::Renderer::CreateDome(float radius, int segmentsLat, int segmentsLon) const
 {
     // -- Data --
-    constexpr float VERTEX_COLOR_CHANNEL = 0.5f;
-    constexpr glm::vec3 VERTEX_COLOR = { VERTEX_COLOR_CHANNEL , VERTEX_COLOR_CHANNEL , VERTEX_COLOR_CHANNEL };
-
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
 
@@ -482,11 +887,7 @@ std::unique_ptr<ashen::Mesh> ashen::Renderer::CreateDome(float radius, int segme
             const float cosPhi = cos(phi);
 
             const glm::vec3 pos = radius * glm::vec3(cosPhi * sinTheta, cosTheta, sinPhi * sinTheta);
-            vertices.push_back(
-                {
-                	.pos = pos,
-                	.color = VERTEX_COLOR
-                });
+            vertices.push_back({ .pos = pos });
         }
     }
 
@@ -508,11 +909,52 @@ std::unique_ptr<ashen::Mesh> ashen::Renderer::CreateDome(float radius, int segme
         }
     }
 
+    // -- Emitted row by row, the mesh reorders them for the post-transform cache --
     return std::make_unique<Mesh>(*m_pContext,
         vertices,
-        indices
+        indices,
+        MeshSettings
+        {
+            .layout = m_Settings.vertexLayout,
+            .keepCpuData = m_Settings.keepMeshData,
+            .optimize = m_Settings.optimizeMeshes
+        }
     );
 }
+void ashen::Renderer::DrawDome(VkCommandBuffer cmd, const Pipeline& pipeline, float radius, uint32_t segments,
+    const CameraMatricesPC& camMatrices, uint32_t patchOffset, uint32_t patchCount) const
+{
+    // LOD patches all share one grid, its size takes the place of the segments
+    const uint32_t gridSegments = m_pDomeLod ? m_pDomeLod->GetGridSize() : segments;
+    const DomePC dome
+    {
+        .segmentsLat = gridSegments,
+        .segmentsLon = gridSegments,
+        .radius = radius
+    };
+    vkCmdPushConstants(cmd, pipeline.GetLayoutHandle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(CameraMatricesPC), &camMatrices);
+    vkCmdPushConstants(cmd, pipeline.GetLayoutHandle(), VK_SHADER_STAGE_VERTEX_BIT, sizeof(CameraMatricesPC), sizeof(DomePC), &dome);
+
+    // -- Every patch is an instance of the same grid, placed by its instance data --
+    if (m_pDomeLod)
+    {
+        m_pDomeLod->Draw(cmd, m_pPatchRing->GetBuffer().GetHandle(), patchOffset, patchCount);
+        return;
+    }
+
+    // -- Every dome shares the unit mesh, the radius above is all that differs between them --
+    if (m_pMeshDome)
+    {
+        m_pMeshDome->Bind(cmd);
+        m_pMeshDome->Draw(cmd);
+        return;
+    }
+
+    // -- One instance per ring, each a strip zigzagging between both edges of the ring --
+    constexpr VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(cmd, 0, 1, &m_DomeVertexSource.GetHandle(), &offset);
+    vkCmdDraw(cmd, 2 * (segments + 1), segments, 0, 0);
+}
 
 // -- Creation --
 void ashen::Renderer::CreateSamplers()
@@ -538,30 +980,79 @@ void ashen::Renderer::CreateSamplers()
     if (vkCreateSampler(m_pContext->GetDevice(), &smaplerInfo, nullptr, &m_PostProcessSampler) != VK_SUCCESS)
         throw std::runtime_error("Failed to create Texture Sampler!");
 }
-void ashen::Renderer::CreatePipelines(VkFormat renderFormat)
+void ashen::Renderer::RegisterPipelines(VkFormat sceneFormat)
 {
-    vkDeviceWaitIdle(m_pContext->GetDevice());
-    m_GroundFromAtmosphere.Destroy();
-    m_GroundFromSpace.Destroy();
-    m_SkyFromAtmosphere.Destroy();
-    m_SkyFromSpace.Destroy();
-    m_SpaceFromAtmosphere.Destroy();
-    m_SpaceFromSpace.Destroy();
-    m_PostProcess.Destroy();
+    // -- Scene, one variant per color format, variants that already exist are skipped by the registry --
+    auto registerScene = [this, sceneFormat](const std::string& shader, const DescriptorSet& descriptorSet, bool blended)
+    {
+        m_pPipelines->Register(shader, sceneFormat, [this, sceneFormat, shader, &descriptorSet, blended](Pipeline& pipeline)
+        {
+            BuildScenePipeline(pipeline, sceneFormat, shader, descriptorSet, blended);
+        });
+    };
+    const FrameResources& frame = m_vFrames.front();
+    registerScene("GroundFromSpace", frame.descriptorSetGround, false);
+    registerScene("GroundFromAtmosphere", frame.descriptorSetGround, false);
+    registerScene("SpaceFromSpace", frame.descriptorSetSpace, false);
+    registerScene("SpaceFromAtmosphere", frame.descriptorSetSpace, false);
+    registerScene("SkyFromSpace", frame.descriptorSetSky, true);
+    registerScene("SkyFromAtmosphere", frame.descriptorSetSky, true);
+
+    // -- Specialized Scene, the ground only depends on the sample count, the sky also on the phase function --
+    // Registered after the dynamic pipelines, so those are built first and frames never have to wait on a variant
+    auto registerVariant = [this, sceneFormat](const std::string& shader, const DescriptorSet& descriptorSet, bool blended, int sampleCount, int phaseType)
+    {
+        m_pPipelines->Register(GetVariantName(shader, sampleCount, phaseType), sceneFormat,
+            [this, sceneFormat, shader, &descriptorSet, blended, sampleCount, phaseType](Pipeline& pipeline)
+        {
+            BuildScenePipeline(pipeline, sceneFormat, shader, descriptorSet, blended, sampleCount, phaseType);
+        });
+    };
+    for (const int sampleCount : SPECIALIZED_SAMPLE_COUNTS)
+    {
+        registerVariant("GroundFromSpace", frame.descriptorSetGround, false, sampleCount, -1);
+        registerVariant("GroundFromAtmosphere", frame.descriptorSetGround, false, sampleCount, -1);
+        for (uint32_t phaseType{}; phaseType < m_PhaseFunctionCount; ++phaseType)
+        {
+            registerVariant("SkyFromSpace", frame.descriptorSetSky, true, sampleCount, static_cast<int>(phaseType));
+            registerVariant("SkyFromAtmosphere", frame.descriptorSetSky, true, sampleCount, static_cast<int>(phaseType));
+        }
+    }
 
+    // -- Post Process, always writes the swapchain --
+    m_pPipelines->Register("PostProcess", m_pContext->GetSwapchainFormat(), [this](Pipeline& pipeline)
+    {
+        BuildPostProcessPipeline(pipeline);
+    });
+}
+void ashen::Renderer::BuildScenePipeline(Pipeline& pipeline, VkFormat colorFormat, const std::string& shader, const DescriptorSet& descriptorSet, bool blended,
+    int sampleCount, int phaseType) const
+{
+    // Runs on a background thread, everything it points the builder at has to be local
     VkPipelineRenderingCreateInfo pipelineRenderingInfo{};
     pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
     pipelineRenderingInfo.colorAttachmentCount = 1;
-    VkFormat format = renderFormat;
-    VkFormat swapchainFormat = m_pContext->GetSwapchainFormat();
-    pipelineRenderingInfo.pColorAttachmentFormats = &format;
-    pipelineRenderingInfo.depthAttachmentFormat = m_vDepthImages.front().GetFormat();
-
-    auto attr = Vertex::GetAttributeDescriptions();
-    auto bind = Vertex::GetBindingDescription();
+    pipelineRenderingInfo.pColorAttachmentFormats = &colorFormat;
+    pipelineRenderingInfo.depthAttachmentFormat = m_DepthFormat;
+
+    // -- Ground, sky & space all draw the unit dome --
+    // Procedural domes have no mesh, one triangle strip per ring is generated from the push constants.
+    // LOD domes have no mesh either, an indexed grid per patch is placed from the instance data.
+    const Mesh* pMesh = m_pMeshDome.get();
+    VertexLayout vertexLayout = VertexLayout::Procedural;
+    if (m_pDomeLod) vertexLayout = VertexLayout::Patches;
+    else if (pMesh) vertexLayout = pMesh->GetVertexLayout();
+    const float positionScale = pMesh ? pMesh->GetPositionScale() : 1.f;
+    const auto attr = Vertex::GetAttributeDescriptions(vertexLayout);
+    const auto bind = Vertex::GetBindingDescription(vertexLayout);
+
+    const std::string prefix = "shaders/";
+    const std::string vert = ".vert.spv";
+    const std::string frag = ".frag.spv";
 
     PipelineBuilder pipelineBuilder{ *m_pContext };
     pipelineBuilder
+        .EnablePipelineLibrary(m_Settings.pipelineLibrary)
         .SetVertexAttributeDesc(attr)
         .SetVertexBindingDesc(bind)
 
@@ -571,98 +1062,56 @@ void ashen::Renderer::CreatePipelines(VkFormat renderFormat)
         .SetDepthTest(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS)
 
         .SetCullMode(VK_CULL_MODE_BACK_BIT)
-        .SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+        .SetPrimitiveTopology(vertexLayout == VertexLayout::Procedural ? VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
         .SetPolygonMode(VK_POLYGON_MODE_FILL)
 
-        .SetupDynamicRendering(pipelineRenderingInfo);
-
-    std::string prefix = "shaders/";
-    std::string vert = ".vert.spv";
-    std::string frag = ".frag.spv";
-
-    pipelineBuilder
-        .AddPushConstantRange()
-	        .SetSize(sizeof(CameraMatricesPC))
-	        .SetOffset(0)
-	        .SetStageFlags(VK_SHADER_STAGE_VERTEX_BIT)
-	        .EndRange()
-        .AddDescriptorSet(m_vDescriptorSetsGround.front())
-        .SetCullMode(VK_CULL_MODE_BACK_BIT)
-        .SetVertexShader(prefix + "GroundFromSpace" + vert)
-        .SetFragmentShader(prefix + "GroundFromSpace" + frag)
-        .Build(m_GroundFromSpace);
+        .SetupDynamicRendering(pipelineRenderingInfo)
 
-    pipelineBuilder
         .AddPushConstantRange()
-	        .SetSize(sizeof(CameraMatricesPC))
+	        .SetSize(sizeof(CameraMatricesPC) + sizeof(DomePC))
 	        .SetOffset(0)
 	        .SetStageFlags(VK_SHADER_STAGE_VERTEX_BIT)
 	        .EndRange()
-        .AddDescriptorSet(m_vDescriptorSetsGround.front())
-        .SetCullMode(VK_CULL_MODE_BACK_BIT)
-        .SetVertexShader(prefix + "GroundFromAtmosphere" + vert)
-        .SetFragmentShader(prefix + "GroundFromAtmosphere" + frag)
-        .Build(m_GroundFromAtmosphere);
+        .AddDescriptorSet(descriptorSet)
+        .SetVertexShader(prefix + shader + vert)
+        .SetFragmentShader(prefix + shader + frag)
 
-    pipelineBuilder
-        .AddPushConstantRange()
-	        .SetSize(sizeof(CameraMatricesPC))
-	        .SetOffset(0)
-	        .SetStageFlags(VK_SHADER_STAGE_VERTEX_BIT)
-	        .EndRange()
-        .AddDescriptorSet(m_vDescriptorSetsSpace.front())
-        .SetCullMode(VK_CULL_MODE_BACK_BIT)
-        .SetVertexShader(prefix + "SpaceFromSpace" + vert)
-        .SetFragmentShader(prefix + "SpaceFromSpace" + frag)
-        .Build(m_SpaceFromSpace);
+        // -- 0 & -1 are the shaders' defaults, they read the sample count & phase function from the uniform buffers --
+        .AddSpecializationConstant(0, sampleCount)
+        .AddSpecializationConstant(1, phaseType)
 
-    pipelineBuilder
-        .AddPushConstantRange()
-	        .SetSize(sizeof(CameraMatricesPC))
-	        .SetOffset(0)
-	        .SetStageFlags(VK_SHADER_STAGE_VERTEX_BIT)
-	        .EndRange()
-        .AddDescriptorSet(m_vDescriptorSetsSpace.front())
-        .SetCullMode(VK_CULL_MODE_BACK_BIT)
-        .SetVertexShader(prefix + "SpaceFromAtmosphere" + vert)
-        .SetFragmentShader(prefix + "SpaceFromAtmosphere" + frag)
-        .Build(m_SpaceFromAtmosphere);
+        // -- How the vertex shader unpacks the mesh's positions --
+        .AddSpecializationConstant(2, static_cast<int32_t>(vertexLayout))
+        .AddSpecializationConstant(3, positionScale);
 
-    pipelineBuilder
-        .AddPushConstantRange()
-	        .SetSize(sizeof(CameraMatricesPC))
-	        .SetOffset(0)
-	        .SetStageFlags(VK_SHADER_STAGE_VERTEX_BIT)
-	        .EndRange()
-        .AddDescriptorSet(m_vDescriptorSetsSky.front())
-        .SetCullMode(VK_CULL_MODE_FRONT_BIT)
-        .SetVertexShader(prefix + "SkyFromSpace" + vert)
-        .SetFragmentShader(prefix + "SkyFromSpace" + frag)
-        .SetDepthTest(VK_TRUE, VK_FALSE, VK_COMPARE_OP_LESS)
-        .EnableColorBlend(0, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD)
-        .EnableAlphaBlend(0, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD)
-        .Build(m_SkyFromSpace);
+    // -- The sky shell is seen from the inside and blends over the ground without occluding it --
+    if (blended)
+    {
+        pipelineBuilder
+            .SetCullMode(VK_CULL_MODE_FRONT_BIT)
+            .SetDepthTest(VK_TRUE, VK_FALSE, VK_COMPARE_OP_LESS)
+            .EnableColorBlend(0, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD)
+            .EnableAlphaBlend(0, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD);
+    }
+    pipelineBuilder.Build(pipeline);
+}
+void ashen::Renderer::BuildPostProcessPipeline(Pipeline& pipeline) const
+{
+    VkFormat swapchainFormat = m_pContext->GetSwapchainFormat();
 
-    pipelineBuilder
-        .AddPushConstantRange()
-	        .SetSize(sizeof(CameraMatricesPC))
-	        .SetOffset(0)
-	        .SetStageFlags(VK_SHADER_STAGE_VERTEX_BIT)
-	        .EndRange()
-        .AddDescriptorSet(m_vDescriptorSetsSky.front())
-        .SetCullMode(VK_CULL_MODE_FRONT_BIT)
-        .SetVertexShader(prefix + "SkyFromAtmosphere" + vert)
-        .SetFragmentShader(prefix + "SkyFromAtmosphere" + frag)
-        .SetDepthTest(VK_TRUE, VK_FALSE, VK_COMPARE_OP_LESS)
-        .EnableColorBlend(0, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD)
-        .EnableAlphaBlend(0, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD)
-        .Build(m_SkyFromAtmosphere);
+    VkPipelineRenderingCreateInfo pipelineRenderingInfo{};
+    pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    pipelineRenderingInfo.colorAttachmentCount = 1;
+    pipelineRenderingInfo.pColorAttachmentFormats = &swapchainFormat;
+    pipelineRenderingInfo.depthAttachmentFormat = m_DepthFormat;
 
+    const std::string prefix = "shaders/";
+    const std::string vert = ".vert.spv";
+    const std::string frag = ".frag.spv";
 
-    // post process
-    pipelineRenderingInfo.pColorAttachmentFormats = &swapchainFormat;
-    pipelineBuilder = { *m_pContext };
+    PipelineBuilder pipelineBuilder{ *m_pContext };
     pipelineBuilder
+        .EnablePipelineLibrary(m_Settings.pipelineLibrary)
         .AddPushConstantRange()
             .SetSize(sizeof(Exposure))
             .SetOffset(0)
@@ -675,70 +1124,124 @@ void ashen::Renderer::CreatePipelines(VkFormat renderFormat)
         .SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
         .SetPolygonMode(VK_POLYGON_MODE_FILL)
         .SetupDynamicRendering(pipelineRenderingInfo)
-        .AddDescriptorSet(m_vDescriptorSetsPostProcess.front())
+        .AddDescriptorSet(m_vFrames.front().descriptorSetPostProcess)
         .SetVertexShader(prefix + "FullscreenTri" + vert)
         .SetFragmentShader(prefix + "PostProcess" + frag)
         .SetDepthTest(VK_FALSE, VK_FALSE, VK_COMPARE_OP_NEVER)
-        .Build(m_PostProcess);
+        .Build(pipeline);
+}
+const ashen::Renderer::ScenePipelines& ashen::Renderer::GetScenePipelines(bool hdr)
+{
+    // Resolved on first use, only waits if the background build of that variant has not finished yet
+    ScenePipelines& pipelines = hdr ? m_HDRPipelines : m_LDRPipelines;
+    if (pipelines.pGroundFromSpace)
+        return pipelines;
+
+    const VkFormat format = hdr ? m_HDRTargetFormat.load() : m_pContext->GetSwapchainFormat();
+    pipelines.pSkyFromSpace         = &m_pPipelines->Get("SkyFromSpace", format);
+    pipelines.pSkyFromAtmosphere    = &m_pPipelines->Get("SkyFromAtmosphere", format);
+    pipelines.pGroundFromSpace      = &m_pPipelines->Get("GroundFromSpace", format);
+    pipelines.pGroundFromAtmosphere = &m_pPipelines->Get("GroundFromAtmosphere", format);
+    pipelines.pSpaceFromSpace       = &m_pPipelines->Get("SpaceFromSpace", format);
+    pipelines.pSpaceFromAtmosphere  = &m_pPipelines->Get("SpaceFromAtmosphere", format);
+    if (hdr)
+        pipelines.pPostProcess      = &m_pPipelines->Get("PostProcess", m_pContext->GetSwapchainFormat());
+    return pipelines;
+}
+ashen::Renderer::ScenePipelines ashen::Renderer::SelectScenePipelines(bool hdr, int sampleCount, uint32_t phaseType)
+{
+    ScenePipelines pipelines = GetScenePipelines(hdr);
+    if (std::find(SPECIALIZED_SAMPLE_COUNTS.begin(), SPECIALIZED_SAMPLE_COUNTS.end(), sampleCount) == SPECIALIZED_SAMPLE_COUNTS.end())
+        return pipelines;
 
+    // -- Variants that are not built yet keep the dynamic pipeline --
+    const VkFormat format = hdr ? m_HDRTargetFormat.load() : m_pContext->GetSwapchainFormat();
+    auto select = [this, format, sampleCount](const Pipeline*& pPipeline, const std::string& shader, int variantPhase)
+    {
+        if (const Pipeline* pVariant = m_pPipelines->TryGet(GetVariantName(shader, sampleCount, variantPhase), format))
+            pPipeline = pVariant;
+    };
+    select(pipelines.pGroundFromSpace, "GroundFromSpace", -1);
+    select(pipelines.pGroundFromAtmosphere, "GroundFromAtmosphere", -1);
+    select(pipelines.pSkyFromSpace, "SkyFromSpace", static_cast<int>(phaseType));
+    select(pipelines.pSkyFromAtmosphere, "SkyFromAtmosphere", static_cast<int>(phaseType));
+    return pipelines;
+}
+std::string ashen::Renderer::GetVariantName(const std::string& shader, int sampleCount, int phaseType)
+{
+    std::string name = shader + "/Samples" + std::to_string(sampleCount);
+    if (phaseType >= 0)
+        name += "/Phase" + std::to_string(phaseType);
+    return name;
+}
+void ashen::Renderer::CreateUniformBuffers()
+{
+    m_pUniformRing = std::make_unique<UniformRingBuffer>(*m_pContext, m_Settings.framesInFlight);
+
+    // -- The most patches both domes can have, bound as instance data at the offsets the frame pushed them to --
+    // Counted with the meshes in the memory stats, it replaces the dome vertex buffers
+    if (m_pDomeLod)
+    {
+        const VkDeviceSize patchCapacity = 2 * static_cast<VkDeviceSize>(m_pDomeLod->GetPatchCapacity()) * sizeof(DomeLod::Patch);
+        m_pPatchRing = std::make_unique<UniformRingBuffer>(*m_pContext, m_Settings.framesInFlight, patchCapacity,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, MemoryTag::Mesh);
+    }
 }
 void ashen::Renderer::CreateDescriptorSets()
 {
     DescriptorPoolBuilder builder{ *m_pContext };
-    auto count = m_pContext->GetSwapchainImageCount();
+    const auto count = m_Settings.framesInFlight;
     builder
-        .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, count * 3 * 2)
+        .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, count * 3 * 2)
         .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, count)
         .SetMaxSets(count * 4)
         .SetFlags(0)
         .Build(m_DescriptorPool);
 
-    m_vDescriptorSetsSky.resize(count);
-    m_vDescriptorSetsGround.resize(count);
-    m_vDescriptorSetsSpace.resize(count);
-    m_vDescriptorSetsPostProcess.resize(count);
-    for (uint32_t i{}; i < count; ++i)
+    // Every set points at the start of the ring, the dynamic offsets of the frame select the data at bind time
+    const Buffer& uniformRing = m_pUniformRing->GetBuffer();
+    for (FrameResources& frame : m_vFrames)
     {
         DescriptorSetAllocator allocator{ *m_pContext };
         DescriptorSetWriter writer{ *m_pContext };
 
         allocator
             .NewLayoutBinding()
-	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
 	            .SetCount(1)
 	            .SetShaderStages(VK_SHADER_STAGE_VERTEX_BIT)
 	            .EndLayoutBinding()
             .NewLayoutBinding()
-	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
 	            .SetCount(1)
 	            .SetShaderStages(VK_SHADER_STAGE_FRAGMENT_BIT)
 	            .EndLayoutBinding()
-            .Allocate(m_DescriptorPool, m_vDescriptorSetsSky[i]);
+            .Allocate(m_DescriptorPool, frame.descriptorSetSky);
 
         allocator
             .NewLayoutBinding()
-	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
 	            .SetCount(1)
 	            .SetShaderStages(VK_SHADER_STAGE_VERTEX_BIT)
 	            .EndLayoutBinding()
             .NewLayoutBinding()
-	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
 	            .SetCount(1)
 	            .SetShaderStages(VK_SHADER_STAGE_FRAGMENT_BIT)
 	            .EndLayoutBinding()
-            .Allocate(m_DescriptorPool, m_vDescriptorSetsGround[i]);
+            .Allocate(m_DescriptorPool, frame.descriptorSetGround);
         allocator
             .NewLayoutBinding()
-	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
 	            .SetCount(1)
 	            .SetShaderStages(VK_SHADER_STAGE_VERTEX_BIT)
 	            .EndLayoutBinding()
             .NewLayoutBinding()
-	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+	            .SetType(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
 	            .SetCount(1)
 	            .SetShaderStages(VK_SHADER_STAGE_FRAGMENT_BIT)
 	            .EndLayoutBinding()
-            .Allocate(m_DescriptorPool, m_vDescriptorSetsSpace[i]);
+            .Allocate(m_DescriptorPool, frame.descriptorSetSpace);
 
         allocator
             .NewLayoutBinding()
@@ -746,104 +1249,94 @@ void ashen::Renderer::CreateDescriptorSets()
                 .SetCount(1)
                 .SetShaderStages(VK_SHADER_STAGE_FRAGMENT_BIT)
                 .EndLayoutBinding()
-            .Allocate(m_DescriptorPool, m_vDescriptorSetsPostProcess[i]);
+            .Allocate(m_DescriptorPool, frame.descriptorSetPostProcess);
 
         writer
-            .AddBufferInfo(m_vUBOSky_VS[i], 0, sizeof(SkyVS))
-            .WriteBuffers(m_vDescriptorSetsSky[i], 0)
+            .AddBufferInfo(uniformRing, 0, sizeof(SkyVS))
+            .WriteBuffers(frame.descriptorSetSky, 0)
             .Execute();
         writer
-            .AddBufferInfo(m_vUBOSky_FS[i], 0, sizeof(SkyFS))
-            .WriteBuffers(m_vDescriptorSetsSky[i], 1)
+            .AddBufferInfo(uniformRing, 0, sizeof(SkyFS))
+            .WriteBuffers(frame.descriptorSetSky, 1)
             .Execute();
 
         writer
-            .AddBufferInfo(m_vUBOGround_VS[i], 0, sizeof(GroundVS))
-            .WriteBuffers(m_vDescriptorSetsGround[i], 0)
+            .AddBufferInfo(uniformRing, 0, sizeof(GroundVS))
+            .WriteBuffers(frame.descriptorSetGround, 0)
             .Execute();
         writer
-            .AddBufferInfo(m_vUBOGround_FS[i], 0, sizeof(GroundFS))
-            .WriteBuffers(m_vDescriptorSetsGround[i], 1)
+            .AddBufferInfo(uniformRing, 0, sizeof(GroundFS))
+            .WriteBuffers(frame.descriptorSetGround, 1)
             .Execute();
 
         writer
-            .AddBufferInfo(m_vUBOSpace_VS[i], 0, sizeof(SpaceVS))
-            .WriteBuffers(m_vDescriptorSetsSpace[i], 0)
-            .Execute();
-        writer
-            .AddBufferInfo(m_vUBOSpace_FS[i], 0, sizeof(SpaceFS))
-            .WriteBuffers(m_vDescriptorSetsSpace[i], 1)
+            .AddBufferInfo(uniformRing, 0, sizeof(SpaceVS))
+            .WriteBuffers(frame.descriptorSetSpace, 0)
             .Execute();
         writer
-            .AddImageInfo((m_vRenderTargets)[i].GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_PostProcessSampler)
-            .WriteImages(m_vDescriptorSetsPostProcess[i], 0)
+            .AddBufferInfo(uniformRing, 0, sizeof(SpaceFS))
+            .WriteBuffers(frame.descriptorSetSpace, 1)
             .Execute();
     }
 }
-void ashen::Renderer::CreateDepthResources(VkExtent2D extent)
+void ashen::Renderer::WritePostProcessDescriptors(const DescriptorSet& descriptorSet, const Image& sceneColor) const
 {
-    m_vDepthImages.clear();
-    m_vDepthImages.resize(m_pContext->GetSwapchainImageCount());
-    for (Image& image : m_vDepthImages)
-    {
-        const auto format = Image::FindSupportedFormat(m_pContext->GetPhysicalDevice(),
-            { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
-            VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
-
-        ImageBuilder imageBuilder{ *m_pContext };
-        imageBuilder
-            .SetWidth(extent.width)
-            .SetHeight(extent.height)
-            .SetTiling(VK_IMAGE_TILING_OPTIMAL)
-            .SetAspectFlags(VK_IMAGE_ASPECT_DEPTH_BIT)
-            .SetViewType(VK_IMAGE_VIEW_TYPE_2D)
-            .SetFormat(format)
-            .SetUsageFlags(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
-            .Build(image);
-    }
+    DescriptorSetWriter writer{ *m_pContext };
+    writer
+        .AddImageInfo(sceneColor.GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_PostProcessSampler)
+        .WriteImages(descriptorSet, 0)
+        .Execute();
 }
-void ashen::Renderer::CreateRenderTargets(VkExtent2D extent)
+VkFormat ashen::Renderer::ResolveHDRFormat(HDRFormat format) const
 {
-    m_vRenderTargets.clear();
-    m_vRenderTargets.resize(m_pContext->GetSwapchainImageCount());
-    for (Image& image : m_vRenderTargets)
-    {
-        ImageBuilder imageBuilder{ *m_pContext };
-        imageBuilder
-            .SetWidth(extent.width)
-            .SetHeight(extent.height)
-            .SetTiling(VK_IMAGE_TILING_OPTIMAL)
-            .SetFormat(VK_FORMAT_R32G32B32A32_SFLOAT)
-            .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
-            .SetViewType(VK_IMAGE_VIEW_TYPE_2D)
-            .SetUsageFlags(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
-            .Build(image);
-    }
+    VkFormat requested = VK_FORMAT_R16G16B16A16_SFLOAT;
+    if (format == HDRFormat::B10G11R11) requested = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+    if (format == HDRFormat::RGBA32F) requested = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+    // The sky blends into the target and the post process samples it, RGBA16F supports both on every desktop device
+    return Image::FindSupportedFormat(m_pContext->GetPhysicalDevice(),
+        { requested, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT },
+        VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+}
+void ashen::Renderer::ChangeHDRFormat(HDRFormat format)
+{
+    // Variants of a format that was used before are still in the registry, only new formats compile anything
+    m_ActiveHDRFormat = format;
+    m_PendingHDRTargetFormat = ResolveHDRFormat(m_ActiveHDRFormat);
+    RegisterPipelines(m_PendingHDRTargetFormat);
+}
+void ashen::Renderer::ApplyPendingHDRFormat()
+{
+    // Frames keep the previous format's target & pipelines until every pipeline of the new one is built, so switching never waits on a compile
+    if (m_PendingHDRTargetFormat == m_HDRTargetFormat || !m_pPipelines->IsReady(m_PendingHDRTargetFormat))
+        return;
+
+    // The next frame asks the attachment pool for a target of the new format, the old one goes once no frame in flight uses it
+    m_HDRTargetFormat = m_PendingHDRTargetFormat;
+    m_HDRPipelines = {};
 }
 void ashen::Renderer::CreateCommandBuffers()
 {
     VkDevice device = m_pContext->GetDevice();
 
     // -- Command Buffers --
-    m_vCommandBuffers.resize(m_pContext->GetSwapchainImageCount());
+    std::vector<VkCommandBuffer> vCommandBuffers(m_vFrames.size());
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = m_pContext->GetCommandPool();
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = static_cast<uint32_t>(m_vCommandBuffers.size());
+    allocInfo.commandBufferCount = static_cast<uint32_t>(vCommandBuffers.size());
 
-    if (vkAllocateCommandBuffers(device, &allocInfo, m_vCommandBuffers.data()) != VK_SUCCESS)
+    if (vkAllocateCommandBuffers(device, &allocInfo, vCommandBuffers.data()) != VK_SUCCESS)
         throw std::runtime_error("Failed to allocate command buffers");
+
+    for (size_t i{}; i < m_vFrames.size(); ++i)
+        m_vFrames[i].commandBuffer = vCommandBuffers[i];
 }
 void ashen::Renderer::CreateSyncObjects()
 {
-    // -- Resize Vectors --
     VkDevice device = m_pContext->GetDevice();
-    size_t maxFramesInFlight = 2;
-    m_vImageAvailableSemaphores.resize(maxFramesInFlight);
-    m_vRenderFinishedSemaphores.resize(maxFramesInFlight);
-    m_vInFlightFences.resize(maxFramesInFlight);
 
     // -- Semaphore Info --
     VkSemaphoreCreateInfo semaphoreInfo{};
@@ -854,194 +1347,178 @@ void ashen::Renderer::CreateSyncObjects()
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    // Creation --
-    for (size_t i = 0; i < maxFramesInFlight; i++) 
+    // -- Creation --
+    for (FrameResources& frame : m_vFrames)
     {
-        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_vImageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_vRenderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &m_vInFlightFences[i]) != VK_SUCCESS)
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frame.imageAvailable) != VK_SUCCESS ||
+            vkCreateFence(device, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS)
         {
             throw std::runtime_error("Failed to create sync objects");
         }
     }
+
+    m_vRenderFinishedSemaphores.resize(m_pContext->GetSwapchainImageCount());
+    for (VkSemaphore& semaphore : m_vRenderFinishedSemaphores)
+    {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create sync objects");
+    }
+}
+void ashen::Renderer::DestroySyncObjects()
+{
+    VkDevice device = m_pContext->GetDevice();
+    for (FrameResources& frame : m_vFrames)
+    {
+        vkDestroySemaphore(device, frame.imageAvailable, nullptr);
+        vkDestroyFence(device, frame.inFlight, nullptr);
+    }
+    for (const auto& sem : m_vRenderFinishedSemaphores) vkDestroySemaphore(device, sem, nullptr);
+    m_vRenderFinishedSemaphores.clear();
 }
 
 // -- Frame --
-void ashen::Renderer::SetupFrame(uint32_t imageIndex) const
+void ashen::Renderer::SetupFrame() const
 {
-    VkCommandBuffer cmd = m_vCommandBuffers[m_CurrentFrame];
+    VkCommandBuffer cmd = m_vFrames[m_CurrentFrame].commandBuffer;
     vkResetCommandBuffer(cmd, 0);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("Failed to begin command buffer!");
     }
 
-    VkImageMemoryBarrier presentBarrier{};
-    presentBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    presentBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    presentBarrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    presentBarrier.srcAccessMask = VK_ACCESS_NONE;
-    presentBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    presentBarrier.image = m_pContext->GetSwapchainImages()[imageIndex];
-    presentBarrier.subresourceRange =
-    {
-        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-        .baseMipLevel = 0, .levelCount = 1,
-        .baseArrayLayer = 0, .layerCount = 1
-    };
+    m_pGpuProfiler->BeginFrame(cmd, m_CurrentFrame, m_FrameIndex);
+    m_pGpuProfiler->BeginScope(cmd, m_ScopeFrame);
 
-    vkCmdPipelineBarrier(
-        cmd,
-        VK_PIPELINE_STAGE_NONE,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &presentBarrier
-    );
-}
-void ashen::Renderer::SetRenderTarget(VkImageView view, VkImageLayout layout)
-{
-    VkCommandBuffer cmd = m_vCommandBuffers[m_CurrentFrame];
-    Image& depthImage = m_vDepthImages[m_CurrentFrame];
-
-    // Dynamic rendering info
-    VkRenderingAttachmentInfo colorAttachment{};
-    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-    colorAttachment.imageView = view;
-    colorAttachment.imageLayout = layout;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.clearValue.color = { {0.f, 0.f, 0.f, 1.0f} };
-
-    VkRenderingAttachmentInfo depthAttachment{};
-    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-    depthAttachment.imageView = depthImage.GetView();
-    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.clearValue.depthStencil = { 1.0f, 0 };
-
-    VkRenderingInfo renderingInfo{};
-    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-    renderingInfo.renderArea.offset = { 0, 0 };
-    renderingInfo.renderArea.extent = m_pContext->GetSwapchainExtent();
-    renderingInfo.layerCount = 1;
-    renderingInfo.colorAttachmentCount = 1;
-    renderingInfo.pColorAttachments = &colorAttachment;
-    renderingInfo.pDepthAttachment = &depthAttachment;
-
-    vkCmdBeginRendering(cmd, &renderingInfo);
-}
-void ashen::Renderer::EndRenderTarget() const
-{
-    VkCommandBuffer cmd = m_vCommandBuffers[m_CurrentFrame];
-    vkCmdEndRendering(cmd);
+    // -- Uploaded images are handed over before anything in the frame reads them, the submit waits on their batch --
+    m_pContext->GetUploadManager().RecordPendingBarriers(cmd);
+
+    if (m_pCommandRecorder)
+        m_pCommandRecorder->BeginFrame(m_CurrentFrame);
 }
-void ashen::Renderer::RenderFrame(uint32_t imageIndex)
+void ashen::Renderer::RenderFrame(uint32_t imageIndex, const FrameSnapshot& snapshot)
 {
-    VkCommandBuffer cmd = m_vCommandBuffers[m_CurrentFrame];
-    Image& renderImage = m_vRenderTargets[m_CurrentFrame];
-
-    auto camPos = m_pCamera->Position;
-    auto camHeight = glm::length(camPos);
-    CameraMatricesPC camMatrices{ m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix() };
-
-    // Transition to be renderable
-    if (m_UseHDR)
+    FrameResources& frame = m_vFrames[m_CurrentFrame];
+
+    const float camHeight = snapshot.cameraHeight;
+    const CameraMatricesPC camMatrices = snapshot.cameraMatrices;
+    const float exposure = snapshot.exposure;
+    const uint32_t domeSegments = snapshot.domeSegments;
+    const uint32_t groundPatchCount = static_cast<uint32_t>(snapshot.groundPatches.size());
+    const uint32_t skyPatchCount = static_cast<uint32_t>(snapshot.skyPatches.size());
+
+    // -- Resources --
+    // The acquire semaphore is waited on at color attachment output, the first transition of the swapchain image chains to it.
+    // Offscreen targets are left ready to be copied out instead of presented.
+    const VkExtent2D extent = m_pContext->GetSwapchainExtent();
+    m_RenderGraph.Reset();
+    const auto backBuffer = m_RenderGraph.ImportImage("BackBuffer",
+        m_pContext->GetSwapchainImages()[imageIndex], m_pContext->GetSwapchainImageViews()[imageIndex],
+        m_pContext->GetSwapchainFormat(), extent, VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        m_pContext->IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    const ScenePipelines pipelines = SelectScenePipelines(m_ActiveHDR, static_cast<int>(snapshot.skyVS.sampleCount), snapshot.skyFS.phaseType);
+
+    // -- Attachments --
+    // One per frame in flight, so frames overlap on the GPU, the fence of this frame already covers the last use of its slot.
+    // Depth is cleared and discarded inside the scene pass, it is transient and never needs memory outside of it.
+    const Image& depthImage = m_pAttachments->Acquire(
+        { .format = m_DepthFormat, .extent = extent, .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, .tag = MemoryTag::Depth, .slot = m_CurrentFrame },
+        m_FrameIndex);
+    const auto depth = m_RenderGraph.ImportImage("Depth", depthImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+
+    auto sceneColor = backBuffer;
+    if (m_ActiveHDR)
     {
-	    renderImage.TransitionLayout(cmd,
-	        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-	        VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_NONE,
-	        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+        const Image& renderTarget = m_pAttachments->Acquire(
+            { .format = m_HDRTargetFormat, .extent = extent, .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+              .tag = MemoryTag::RenderTarget, .slot = m_CurrentFrame },
+            m_FrameIndex);
+        sceneColor = m_RenderGraph.ImportImage("SceneColor", renderTarget, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+
+        // Only rewritten when the pool handed this frame another image, after a resize or a format change
+        if (frame.pPostProcessSource != &renderTarget || frame.postProcessGeneration != m_pAttachments->GetGeneration())
+        {
+            WritePostProcessDescriptors(frame.descriptorSetPostProcess, renderTarget);
+            frame.pPostProcessSource = &renderTarget;
+            frame.postProcessGeneration = m_pAttachments->GetGeneration();
+        }
     }
-
-	SetRenderTarget(m_UseHDR ? renderImage.GetView() : m_pContext->GetSwapchainImageViews()[imageIndex], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    m_pAttachments->ReleaseUnused(m_FrameIndex);
+
+    // -- Scene --
+    // Ground and sky are separate callbacks so they can be recorded on different threads, each binds all of its own state
+    m_RenderGraph.AddPass("Scene")
+        .WriteColor(sceneColor)
+        .WriteDepth(depth)
+        .AddExecute([this, &frame, &pipelines, camHeight, camMatrices, domeSegments, groundPatchCount](VkCommandBuffer cmd)
+        {
+            // -- Space Objects --
+
+            // -- Ground Objects --
+            const Pipeline* pGroundShader;
+            if (camHeight >= m_OuterRadius) pGroundShader = pipelines.pGroundFromSpace;
+            else pGroundShader = pipelines.pGroundFromAtmosphere;
+
+            m_pGpuProfiler->BeginScope(cmd, m_ScopeGround);
+            pGroundShader->Bind(cmd);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pGroundShader->GetLayoutHandle(), 0, 1,
+                &frame.descriptorSetGround.GetHandle(), static_cast<uint32_t>(frame.uniformOffsetsGround.size()), frame.uniformOffsetsGround.data());
+
+            DrawDome(cmd, *pGroundShader, m_InnerRadius, domeSegments, camMatrices, frame.patchOffsetGround, groundPatchCount);
+            m_pGpuProfiler->EndScope(cmd, m_ScopeGround);
+        })
+        .AddExecute([this, &frame, &pipelines, camHeight, camMatrices, domeSegments, skyPatchCount](VkCommandBuffer cmd)
+        {
+            // -- Sky Objects --
+            const Pipeline* pSkyShader;
+            if (camHeight >= m_OuterRadius) pSkyShader = pipelines.pSkyFromSpace;
+            else pSkyShader = pipelines.pSkyFromAtmosphere;
+
+            m_pGpuProfiler->BeginScope(cmd, m_ScopeSky);
+            pSkyShader->Bind(cmd);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pSkyShader->GetLayoutHandle(), 0, 1,
+                &frame.descriptorSetSky.GetHandle(), static_cast<uint32_t>(frame.uniformOffsetsSky.size()), frame.uniformOffsetsSky.data());
+
+            DrawDome(cmd, *pSkyShader, m_OuterRadius, domeSegments, camMatrices, frame.patchOffsetSky, skyPatchCount);
+            m_pGpuProfiler->EndScope(cmd, m_ScopeSky);
+        })
+        .EndPass();
+
+    // -- Post Process --
+    if (m_ActiveHDR)
     {
-        // -- Space Objects --
-
-        // -- Ground Objects --
-        Pipeline* pGroundShader;
-        if (camHeight >= m_OuterRadius) pGroundShader = &m_GroundFromSpace;
-        else pGroundShader = &m_GroundFromAtmosphere;
-
-        pGroundShader->Bind(cmd);
-        m_pMeshFloor->Bind(cmd);
-        vkCmdPushConstants(cmd, pGroundShader->GetLayoutHandle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(CameraMatricesPC), &camMatrices);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pGroundShader->GetLayoutHandle(), 0, 1,
-            &m_vDescriptorSetsGround[m_CurrentFrame].GetHandle(), 0, nullptr);
-
-        m_pMeshFloor->Draw(cmd);
-
-        // -- Sky Objects --
-        Pipeline* pSkyShader;
-        if (camHeight >= m_OuterRadius) pSkyShader = &m_SkyFromSpace;
-        else pSkyShader = &m_SkyFromAtmosphere;
-
-        pSkyShader->Bind(cmd);
-        m_pMeshSky->Bind(cmd);
-        vkCmdPushConstants(cmd, pSkyShader->GetLayoutHandle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(CameraMatricesPC), &camMatrices);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pSkyShader->GetLayoutHandle(), 0, 1,
-            &m_vDescriptorSetsSky[m_CurrentFrame].GetHandle(), 0, nullptr);
-
-        m_pMeshSky->Draw(cmd);
+        m_RenderGraph.AddPass("PostProcess")
+            .Sample(sceneColor)
+            .WriteColor(backBuffer)
+            .AddExecute([this, &frame, &pipelines, exposure](VkCommandBuffer cmd)
+            {
+                const Exposure exposurePC
+                {
+                    .exposure = exposure,
+                };
+                m_pGpuProfiler->BeginScope(cmd, m_ScopePostProcess);
+                const Pipeline& postProcess = *pipelines.pPostProcess;
+                postProcess.Bind(cmd);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, postProcess.GetLayoutHandle(), 0, 1,
+                    &frame.descriptorSetPostProcess.GetHandle(), 0, nullptr);
+                vkCmdPushConstants(cmd, postProcess.GetLayoutHandle(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Exposure), &exposurePC);
+                vkCmdDraw(cmd, 3, 1, 0, 0);
+                m_pGpuProfiler->EndScope(cmd, m_ScopePostProcess);
+            })
+            .EndPass();
     }
-    EndRenderTarget();
-
-    if (!m_UseHDR)
-        return;
-
-    // Transition to be readable
-    renderImage.TransitionLayout(cmd,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
-    SetRenderTarget(m_pContext->GetSwapchainImageViews()[imageIndex], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-    {
-        Exposure exposure
-        {
-            .exposure = m_Exposure,
-        };
-        m_PostProcess.Bind(cmd);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PostProcess.GetLayoutHandle(), 0, 1, 
-            &m_vDescriptorSetsPostProcess[m_CurrentFrame].GetHandle(), 0, nullptr);
-        vkCmdPushConstants(cmd, m_PostProcess.GetLayoutHandle(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Exposure), &exposure);
-        vkCmdDraw(cmd, 3, 1, 0, 0);
-    }
-    EndRenderTarget();
+    m_RenderGraph.Execute(frame.commandBuffer, m_pCommandRecorder.get());
 }
-void ashen::Renderer::EndFrame(uint32_t imageIndex) const
+void ashen::Renderer::EndFrame() const
 {
-    VkCommandBuffer cmd = m_vCommandBuffers[m_CurrentFrame];
-
-    VkImageMemoryBarrier presentBarrier{};
-	presentBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    presentBarrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    presentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    presentBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    presentBarrier.dstAccessMask = 0;
-    presentBarrier.image = m_pContext->GetSwapchainImages()[imageIndex];
-    presentBarrier.subresourceRange =
-    {
-        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-        .baseMipLevel = 0, .levelCount = 1,
-        .baseArrayLayer = 0, .layerCount = 1
-    };
-
-    vkCmdPipelineBarrier(
-        cmd,
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-        0,
-        0, nullptr,
-        0, nullptr,
-        1, &presentBarrier
-    );
+    VkCommandBuffer cmd = m_vFrames[m_CurrentFrame].commandBuffer;
 
+    m_pGpuProfiler->EndScope(cmd, m_ScopeFrame);
 
     if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
         throw std::runtime_error("Failed to record command buffer!");
@@ -1049,40 +1526,30 @@ void ashen::Renderer::EndFrame(uint32_t imageIndex) const
 
 void ashen::Renderer::OnResize()
 {
-    auto size = m_pWindow->GetFramebufferSize();
-    while (size.x == 0 || size.y == 0)
+    // Minimized, there is nothing to render into until the update side's event polling reports a size again
+    const auto size = m_pWindow->GetFramebufferSize();
+    if (size.x == 0 || size.y == 0)
     {
-        size = m_pWindow->GetFramebufferSize();
-        m_pWindow->PollEvents();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return;
     }
 
-    vkDeviceWaitIdle(m_pContext->GetDevice());
     m_pContext->RebuildSwapchain(size);
-    CreateDepthResources(m_pContext->GetSwapchainExtent());
-    CreateRenderTargets(m_pContext->GetSwapchainExtent());
-
-    auto count = m_pContext->GetSwapchainImageCount();
-    for (uint32_t i{}; i < count; ++i)
-    {
-        DescriptorSetWriter writer{ *m_pContext };
-        writer
-            .AddImageInfo((m_vRenderTargets)[i].GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_PostProcessSampler)
-            .WriteImages(m_vDescriptorSetsPostProcess[i], 0)
-            .Execute();
-    }
-
 
-    for (const auto& sem : m_vImageAvailableSemaphores) vkDestroySemaphore(m_pContext->GetDevice(), sem, nullptr);
-    for (const auto& sem : m_vRenderFinishedSemaphores) vkDestroySemaphore(m_pContext->GetDevice(), sem, nullptr);
-    for (const auto& fence : m_vInFlightFences) vkDestroyFence(m_pContext->GetDevice(), fence, nullptr);
+    // The swapchain image count may have changed with the rebuild
+    DestroySyncObjects();
     CreateSyncObjects();
 
-    m_pCamera->AspectRatio = m_pWindow->GetAspectRatio();
+    // So may its format, variants that are missing are compiled and the sets are resolved again on their next use
+    RegisterPipelines(m_pContext->GetSwapchainFormat());
+    m_HDRPipelines = {};
+    m_LDRPipelines = {};
 }
 
-void ashen::Renderer::RecordCommandBuffer(uint32_t imageIndex)
+void ashen::Renderer::RecordCommandBuffer(uint32_t imageIndex, const FrameSnapshot& snapshot)
 {
-    SetupFrame(imageIndex);
-    RenderFrame(imageIndex);
-    EndFrame(imageIndex);
+    SetupFrame();
+    RenderFrame(imageIndex, snapshot);
+    EndFrame();
+    ++m_FrameIndex;
 }
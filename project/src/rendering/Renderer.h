@@ -2,20 +2,56 @@
 #define ASHEN_RENDERER_H
 
 // -- Standard Library --
+#include <array>
+#include <atomic>
 #include <memory>
 #include <numbers>
 
 // -- Ashen Includes --
+#include "AttachmentPool.h"
+#include "Buffer.h"
 #include "Camera.h"
 #include "Descriptors.h"
+#include "DomeLod.h"
+#include "GpuProfiler.h"
 #include "Mesh.h"
 #include "Pipeline.h"
+#include "PipelineRegistry.h"
+#include "RenderGraph.h"
+#include "SecondaryCommandRecorder.h"
+#include "ThreadPool.h"
+#include "TripleBuffer.h"
 #include "Types.h"
+#include "UniformRingBuffer.h"
 #include "VulkanContext.h"
 #include "Window.h"
 
 namespace ashen
 {
+    // -- Scene color formats of HDR rendering, in order of bytes per pixel --
+    // Every pixel of the target is written by the ground, read & written again by the sky blend and read by the post process
+    enum class HDRFormat : uint32_t
+    {
+        B10G11R11,      // 4 bytes, no alpha & no negatives, the sky blend only needs the alpha its shader outputs
+        RGBA16F,        // 8 bytes
+        RGBA32F         // 16 bytes
+    };
+
+    // -- Settings fixed at construction --
+    struct RendererSettings
+    {
+        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+        uint32_t framesInFlight{ 2 };       // 1 - 4, more frames trade input latency for CPU/GPU overlap
+        uint32_t recordingThreads{ 0 };     // Workers recording the passes into secondary command buffers, 0 records everything on the main thread
+        bool pipelineLibrary{ true };       // Link pipelines from shared graphics pipeline library parts, if the device supports them
+        HDRFormat hdrFormat{ HDRFormat::RGBA16F };  // Initial HDR target format, falls back to RGBA16F & RGBA32F if the device can not blend into it
+        VertexLayout vertexLayout{ VertexLayout::Position };   // Vertex buffer layout of the domes, every layout is exact enough for them, procedural has no buffer
+        bool keepMeshData{ false };         // Keep the CPU copies of the dome vertices & indices after they are uploaded
+        bool optimizeMeshes{ true };        // Reorder the dome's triangles for the post-transform cache, each miss runs the scattering loop once more
+        bool domeLod{ true };               // Split the domes into camera dependent patches, the vertex layout & mesh settings only apply without it
+        float domeLodPixelError{ 12.f };    // Initial size in pixels a patch's grid cell may cover on screen before the patch is split
+    };
+
     //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	//? ~~    Renderer
 	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -25,7 +61,7 @@ namespace ashen
         //--------------------------------------------------
 		//    Constructor & Destructor
 		//--------------------------------------------------
-        explicit Renderer(Window* pWindow);
+        explicit Renderer(Window* pWindow, const RendererSettings& settings = {});
         ~Renderer();
 
         Renderer(const Renderer& other) = delete;
@@ -36,8 +72,37 @@ namespace ashen
         //--------------------------------------------------
 		//    Functionality
 		//--------------------------------------------------
+        // Update owns input, stats and every setting below, it ends by publishing a snapshot of them.
+        // Render only reads the latest published snapshot, so it may run on its own thread next to Update.
         void Update();
         void Render();
+        void WaitIdle();
+
+        //--------------------------------------------------
+		//    Settings
+		//--------------------------------------------------
+        Camera& GetCamera() const;
+        void SetInputEnabled(bool enabled);
+        void SetSampleCount(int count);
+        void SetPhaseFunction(uint32_t index);
+        void SetHDR(bool enabled);
+        void SetHDRFormat(HDRFormat format);
+        void SetDomeSegments(uint32_t segments);
+        void SetDomeLodPixelError(float pixels);
+        void SetRayleigh(float kr);
+        void SetMie(float km);
+        void SetLightDirection(const glm::vec3& direction);
+
+        //--------------------------------------------------
+		//    Statistics
+		//--------------------------------------------------
+        uint64_t GetFrameIndex() const;
+        uint32_t GetFramesInFlight() const;
+        std::vector<GpuFrameTiming> ConsumeGpuTimings();
+        const std::vector<std::string>& GetGpuScopeNames() const;
+        std::vector<GpuProfiler::ScopeStats> GetGpuStats() const;
+        MemoryAllocator::Stats GetMemoryStats() const;
+        std::vector<MemoryAllocator::HeapStats> GetHeapStats() const;
 
     private:
         // -- Context --
@@ -80,32 +145,45 @@ namespace ashen
 
         float m_Exposure            { 2.0f };
         bool m_UseHDR               { true };
+        HDRFormat m_HDRFormat       { HDRFormat::RGBA16F };
         bool m_UseOzone             { true };
+        bool m_InputEnabled         { true };
+        uint32_t m_DomeSegments     { 250u };       // Rings & segments of both domes, only changes at runtime when they are procedural
+        float m_DomeLodPixelError   { 12.f };       // Screen space error the dome patches are split down to
+        glm::uvec2 m_DomePatchCounts{ };            // Ground & sky patches of the last snapshot, for the stats
 
         // -- Meshes --
-        std::unique_ptr<Mesh>   m_pMeshFloor;
-        std::unique_ptr<Mesh>   m_pMeshSky;
+        // Ground & sky share one unit dome, every draw pushes its own radius, so another shell only costs a draw.
+        // With the procedural layout there is no mesh, the domes are generated from gl_VertexIndex & the push constants.
+        // The vertex input they do not read is fed from a single zero vertex with a zero stride.
+        // With LOD neither exists, the update side picks the patches of both domes every frame and the render side streams them as instances.
+        std::unique_ptr<Mesh>   m_pMeshDome;
+        bool m_ProceduralDomes  { false };
+        Buffer m_DomeVertexSource{};
+        std::unique_ptr<DomeLod> m_pDomeLod;
         std::unique_ptr<Camera> m_pCamera;
 
         // -- Pipelines --
-        Pipeline                        m_SkyFromSpace          { };
-        Pipeline                        m_SkyFromAtmosphere     { };
-        std::vector<DescriptorSet>      m_vDescriptorSetsSky    { };
-        UniformBufferGroup<SkyVS>       m_vUBOSky_VS            { };
-        UniformBufferGroup<SkyFS>       m_vUBOSky_FS            { };
-
-        Pipeline                        m_GroundFromSpace       { };
-        Pipeline                        m_GroundFromAtmosphere  { };
-        std::vector<DescriptorSet>      m_vDescriptorSetsGround { };
-        UniformBufferGroup<GroundVS>    m_vUBOGround_VS         { };
-        UniformBufferGroup<GroundFS>    m_vUBOGround_FS         { };
-
-        Pipeline                        m_SpaceFromSpace        { };
-        Pipeline                        m_SpaceFromAtmosphere   { };
-        std::vector<DescriptorSet>      m_vDescriptorSetsSpace  { };
-        UniformBufferGroup<SpaceVS>     m_vUBOSpace_VS          { };
-        UniformBufferGroup<SpaceFS>     m_vUBOSpace_FS          { };
+        // Both color format variants are compiled in the background at startup, toggling HDR only switches between the sets.
+        // Switching the HDR format compiles the variants of the new format, the previous formats keep theirs in the registry.
+        struct ScenePipelines
+        {
+            const Pipeline* pSkyFromSpace{};
+            const Pipeline* pSkyFromAtmosphere{};
+            const Pipeline* pGroundFromSpace{};
+            const Pipeline* pGroundFromAtmosphere{};
+            const Pipeline* pSpaceFromSpace{};
+            const Pipeline* pSpaceFromAtmosphere{};
+            const Pipeline* pPostProcess{};         // Only the HDR set tone maps into the swapchain
+        };
+        // Sample counts that also get specialized variants, with the count & phase function baked in as specialization constants.
+        // Frames use a variant once it has finished building and the dynamic pipelines above until then, or for any other count.
+        static constexpr std::array<int, 3> SPECIALIZED_SAMPLE_COUNTS{ 8, 16, 32 };
 
+        std::unique_ptr<ThreadPool>         m_pBackgroundThreads;
+        std::unique_ptr<PipelineRegistry>   m_pPipelines;
+        ScenePipelines                      m_HDRPipelines          { };
+        ScenePipelines                      m_LDRPipelines          { };
 
 
 		//--------------------------------------------------
@@ -114,40 +192,130 @@ namespace ashen
 
         // -- Meshes --
         std::unique_ptr<Mesh> CreateDome(float radius, int segmentsLat, int segmentsLon) const;
+        void DrawDome(VkCommandBuffer cmd, const Pipeline& pipeline, float radius, uint32_t segments,
+            const CameraMatricesPC& camMatrices, uint32_t patchOffset = 0, uint32_t patchCount = 0) const;
 
         // -- Creation --
         void CreateSamplers();
-        void CreatePipelines(VkFormat renderFormat);
+        void RegisterPipelines(VkFormat sceneFormat);
+        void BuildScenePipeline(Pipeline& pipeline, VkFormat colorFormat, const std::string& shader, const DescriptorSet& descriptorSet, bool blended,
+            int sampleCount = 0, int phaseType = -1) const;
+        void BuildPostProcessPipeline(Pipeline& pipeline) const;
+        const ScenePipelines& GetScenePipelines(bool hdr);
+        ScenePipelines SelectScenePipelines(bool hdr, int sampleCount, uint32_t phaseType);
+        static std::string GetVariantName(const std::string& shader, int sampleCount, int phaseType);
+        void CreateUniformBuffers();
         void CreateDescriptorSets();
-        void CreateDepthResources(VkExtent2D extent);
-        void CreateRenderTargets(VkExtent2D extent);
+        void WritePostProcessDescriptors(const DescriptorSet& descriptorSet, const Image& sceneColor) const;
+        VkFormat ResolveHDRFormat(HDRFormat format) const;
+        void ChangeHDRFormat(HDRFormat format);
+        void ApplyPendingHDRFormat();
         void CreateCommandBuffers();
         void CreateSyncObjects();
+        void DestroySyncObjects();
+
+        // -- Snapshot --
+        // Everything the render side needs from the update side, built once per update and never modified after publishing
+        struct FrameSnapshot
+        {
+            SkyVS skyVS;
+            SkyFS skyFS;
+            GroundVS groundVS;
+            GroundFS groundFS;
+            SpaceVS spaceVS;
+            SpaceFS spaceFS;
+
+            CameraMatricesPC cameraMatrices;
+            float cameraHeight;
+            float exposure;
+            bool useHDR;
+            HDRFormat hdrFormat;
+            uint32_t domeSegments;
+
+            // Visible patches of both domes, empty without LOD
+            std::vector<DomeLod::Patch> groundPatches;
+            std::vector<DomeLod::Patch> skyPatches;
+        };
+        TripleBuffer<FrameSnapshot> m_Snapshots{};
+        bool m_ActiveHDR{ true };                       // Render side, which target & pipeline set the frames use
+        HDRFormat m_ActiveHDRFormat{};                  // Render side, the format the pipelines were last registered for
+        std::atomic<VkFormat> m_HDRTargetFormat{};      // What the frames render into on this device, read by the stats
+        std::atomic<uint32_t> m_PresentedFrames{};      // Counted by the render side, read & reset by the stats once per second
+        VkFormat m_PendingHDRTargetFormat{};            // Render side, what the active format resolved to, used once all its pipelines are built
+
+        void PublishSnapshot();
+        void WriteUniforms(const FrameSnapshot& snapshot);
 
         // -- Frame --
-        void SetupFrame(uint32_t imageIndex) const;
-        void SetRenderTarget(VkImageView view, VkImageLayout layout);
-        void EndRenderTarget() const;
-        void RenderFrame(uint32_t imageIndex);
-        void EndFrame(uint32_t imageIndex) const;
-        void RecordCommandBuffer(uint32_t imageIndex);
+        void SetupFrame() const;
+        void RenderFrame(uint32_t imageIndex, const FrameSnapshot& snapshot);
+        void EndFrame() const;
+        void RecordCommandBuffer(uint32_t imageIndex, const FrameSnapshot& snapshot);
+        void RenderHeadless(const FrameSnapshot& snapshot);
+        void WaitForFrame();
         void OnResize();
 
-        // -- Buffers --
+        // -- Per-Frame Resources --
+        // Everything a frame in flight records into or reads from, indexed by m_CurrentFrame and never by swapchain image
+        struct FrameResources
+        {
+            VkCommandBuffer commandBuffer{};
+
+            // Dynamic offsets into the uniform ring, in binding order of their set (vertex, fragment)
+            std::array<uint32_t, 2> uniformOffsetsSky{};
+            std::array<uint32_t, 2> uniformOffsetsGround{};
+            std::array<uint32_t, 2> uniformOffsetsSpace{};
+
+            // Where the dome patches start in the patch ring
+            uint32_t patchOffsetGround{};
+            uint32_t patchOffsetSky{};
+
+            DescriptorSet descriptorSetSky{};
+            DescriptorSet descriptorSetGround{};
+            DescriptorSet descriptorSetSpace{};
+            DescriptorSet descriptorSetPostProcess{};
+            const Image* pPostProcessSource{};      // What the post process set samples, with the pool generation it was written at
+            uint64_t postProcessGeneration{};
+
+            VkSemaphore imageAvailable{};
+            VkFence inFlight{};
+        };
+        RendererSettings m_Settings{};
         DescriptorPool m_DescriptorPool{};
-        std::vector<VkCommandBuffer> m_vCommandBuffers;
-        std::vector<Image> m_vDepthImages;
+        std::vector<FrameResources> m_vFrames;
+        std::unique_ptr<UniformRingBuffer> m_pUniformRing;
+        std::unique_ptr<UniformRingBuffer> m_pPatchRing;    // Per instance dome patches, only with LOD
+
+        // -- Attachments --
+        // Depth & the HDR scene color are shared by all frames in flight, the pool only reallocates them when their extent or format changes
+        std::unique_ptr<AttachmentPool> m_pAttachments;
+        VkFormat m_DepthFormat{};
 
-        std::vector<Image>              m_vRenderTargets;
-        Pipeline                        m_PostProcess{ };
-        std::vector<DescriptorSet>      m_vDescriptorSetsPostProcess{ };
         VkSampler                       m_PostProcessSampler{};
 
+        // -- Graph --
+        RenderGraph m_RenderGraph;
+
+        // -- Recording --
+        // Only created when recording threads were requested, the graph records inline without a recorder
+        std::unique_ptr<ThreadPool> m_pRecordingThreads;
+        std::unique_ptr<SecondaryCommandRecorder> m_pCommandRecorder;
+
         // -- Sync --
-        std::vector<VkSemaphore> m_vImageAvailableSemaphores;
+        // Presentation keeps waiting on its semaphore until the image is acquired again, so these follow the swapchain images
         std::vector<VkSemaphore> m_vRenderFinishedSemaphores;
-        std::vector<VkFence> m_vInFlightFences;
         uint32_t m_CurrentFrame = 0;
+        uint32_t m_OffscreenImageIndex = 0;
+        uint64_t m_FrameIndex = 0;
+
+        // -- Profiling --
+        // Scope 0 brackets the whole frame, the others bracket the individual passes
+        std::unique_ptr<GpuProfiler> m_pGpuProfiler;
+        uint32_t m_ScopeFrame{};
+        uint32_t m_ScopeGround{};
+        uint32_t m_ScopeSky{};
+        uint32_t m_ScopePostProcess{};
+        uint32_t m_PrintedStatLines{};
 
         // -- Helper --
         void HandleInput();
@@ -3,6 +3,8 @@
 
 // -- Standard Library --
 #include <array>
+#include <cstdint>
+#include <vector>
 
 // -- Math Includes --
 #include "glm/glm.hpp"
@@ -12,39 +14,65 @@
 
 namespace ashen
 {
+    // -- How vertex positions are stored in the vertex buffer --
+    // The quantized layouts store positions relative to the furthest vertex from the origin, the shaders scale them back.
+    // The values match VERTEX_LAYOUT in Helper_Vertex.glsl.
+    enum class VertexLayout : uint32_t
+    {
+        Position,       // 12 bytes, float3
+        UnitSphere16,   // 8 bytes, snorm16 x4 of the position divided by the scale, w is padding
+        Octahedral16,   // 4 bytes, snorm16 x2 octahedral direction, only for meshes whose vertices all lie on a sphere
+        Procedural,     // 0 bytes, not a Mesh layout, the renderer generates its domes in the vertex shader
+        Patches         // 16 bytes per instance, not a Mesh layout, a DomeLod patch for every instance of its shared grid
+    };
+
     //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	//? ~~    Vertex
 	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     struct Vertex
     {
         glm::vec3 pos;
-        glm::vec3 color;
 
-        static VkVertexInputBindingDescription GetBindingDescription()
+        static uint32_t GetStride(VertexLayout layout)
+        {
+            switch (layout)
+            {
+            case VertexLayout::UnitSphere16:    return 4 * sizeof(int16_t);
+            case VertexLayout::Octahedral16:    return 2 * sizeof(int16_t);
+            case VertexLayout::Procedural:      return 0;
+            case VertexLayout::Patches:         return 4 * sizeof(float);
+            default:                            return sizeof(glm::vec3);
+            }
+        }
+
+        static VkVertexInputBindingDescription GetBindingDescription(VertexLayout layout = VertexLayout::Position)
         {
             VkVertexInputBindingDescription binding{};
             binding.binding = 0;
-            binding.stride = sizeof(Vertex);
-            binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            binding.stride = GetStride(layout);
+            binding.inputRate = layout == VertexLayout::Patches ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX;
             return binding;
         }
 
-        static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions()
+        static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(VertexLayout layout = VertexLayout::Position)
         {
-            std::vector<VkVertexInputAttributeDescription> attrs{2};
+            // Every layout feeds the same vec4 input, components a format does not have read as 0 and w as 1.
+            // The procedural layout never reads it, but the input still needs a source, a zero stride buffer of a single vertex.
+            std::vector<VkVertexInputAttributeDescription> attrs{1};
             attrs[0].binding = 0;
             attrs[0].location = 0;
-            attrs[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attrs[0].offset = offsetof(Vertex, pos);
-
-            attrs[1].binding = 0;
-            attrs[1].location = 1;
-            attrs[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attrs[1].offset = offsetof(Vertex, color);
+            attrs[0].offset = 0;
+            switch (layout)
+            {
+            case VertexLayout::UnitSphere16:    attrs[0].format = VK_FORMAT_R16G16B16A16_SNORM; break;
+            case VertexLayout::Octahedral16:    attrs[0].format = VK_FORMAT_R16G16_SNORM;       break;
+            case VertexLayout::Patches:         attrs[0].format = VK_FORMAT_R32G32B32A32_SFLOAT; break;
+            default:                            attrs[0].format = VK_FORMAT_R32G32B32_SFLOAT;   break;
+            }
 
             return attrs;
         }
     };
 }
 
-#endif // ASHEN_VERTEX_H
\ No newline at end of file
+#endif // ASHEN_VERTEX_H
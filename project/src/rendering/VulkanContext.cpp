@@ -1,25 +1,37 @@
 // -- Standard Library --
+#include <algorithm>
 #include <iostream>
 
 // -- Ashen Includes --
 #include "VulkanContext.h"
+#include "MemoryAllocator.h"
+#include "PipelineCache.h"
+#include "PipelineLibraryCache.h"
+#include "ShaderModuleCache.h"
+#include "UploadManager.h"
 
 //--------------------------------------------------
 //    Constructor & Destructor
 //--------------------------------------------------
-ashen::VulkanContext::VulkanContext(Window* window)
+ashen::VulkanContext::VulkanContext(Window* window, uint32_t offscreenImageCount)
+	: m_IsHeadless(window->IsHeadless())
+	, m_OffscreenImageCount(std::max(offscreenImageCount, 2u))
 {
     vkb::InstanceBuilder builder;
     auto inst_ret = builder.set_app_name("Ashen")
         .request_validation_layers(true)
         .use_default_debug_messenger()
 		.require_api_version(VK_API_VERSION_1_3)
+		.set_headless(m_IsHeadless)
         .build();
     if (!inst_ret) throw std::runtime_error("Failed to create Vulkan instance");
     m_VkbInstance = inst_ret.value();
 
-    if (glfwCreateWindowSurface(m_VkbInstance.instance, window->GetGLFWwindow(), nullptr, &m_Surface) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create Vulkan surface");
+	if (!m_IsHeadless)
+	{
+		if (glfwCreateWindowSurface(m_VkbInstance.instance, window->GetGLFWwindow(), nullptr, &m_Surface) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create Vulkan surface");
+	}
 
 	// -- Features --
 	// -- Vulkan API Core Features --
@@ -41,6 +53,7 @@ ashen::VulkanContext::VulkanContext(Window* window)
 	vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
 	vulkan12Features.descriptorIndexing = VK_TRUE;
 	vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	vulkan12Features.timelineSemaphore = VK_TRUE;
 
 	// -- Vulkan API 1.3 Features --
 	VkPhysicalDeviceVulkan13Features vulkan13Features{};
@@ -48,10 +61,17 @@ ashen::VulkanContext::VulkanContext(Window* window)
 	vulkan13Features.dynamicRendering = VK_TRUE;
 	vulkan13Features.synchronization2 = VK_TRUE;
 
+	// -- Headless instances have no surface, any device type (including CPU implementations) is accepted --
     vkb::PhysicalDeviceSelector selector{ m_VkbInstance };
+	if (!m_IsHeadless)
+	{
+		selector
+			.set_surface(m_Surface)
+			.add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
+	else selector.allow_any_gpu_device_type(true);
+
     auto phys_ret = selector
-		.set_surface(m_Surface)
-		.add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
 		.add_required_extension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)
 		.add_required_extension(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME)
 		.add_required_extension(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)
@@ -63,14 +83,74 @@ ashen::VulkanContext::VulkanContext(Window* window)
     if (!phys_ret) throw std::runtime_error("Failed to select GPU");
     m_VkbPhysicalDevice = phys_ret.value();
 
+	// -- Optional Features --
+	VkPhysicalDeviceFeatures optionalFeatures{};
+	optionalFeatures.pipelineStatisticsQuery = VK_TRUE;
+	m_VkbPhysicalDevice.enable_features_if_present(optionalFeatures);
+
+	// -- Optional Extensions --
+	// Graphics pipeline libraries let variants be linked from shared parts, without them every pipeline is built whole
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures{};
+	pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+	pipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+	m_SupportsPipelineLibrary = m_VkbPhysicalDevice.enable_extension_if_present(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)
+		&& m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)
+		&& m_VkbPhysicalDevice.enable_extension_features_if_present(pipelineLibraryFeatures);
+
+	// The memory budget reports what the OS lets this process use per heap, next to what it already uses
+	m_SupportsMemoryBudget = m_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
     vkb::DeviceBuilder device_builder{ m_VkbPhysicalDevice };
     auto dev_ret = device_builder
 		.build();
     if (!dev_ret) throw std::runtime_error("Failed to create device");
     m_VkbDevice = dev_ret.value();
 
-	VkSurfaceFormatKHR format{ VK_FORMAT_B8G8R8A8_SRGB , VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = GetQueueIndex(vkb::QueueType::graphics);
+
+	vkCreateCommandPool(m_VkbDevice.device, &poolInfo, nullptr, &m_CommandPool);
+
+	// -- Memory --
+	// Has to exist before the first Buffer or Image, the offscreen targets included
+	m_pMemoryAllocator = std::make_unique<MemoryAllocator>(m_VkbDevice.device, m_VkbPhysicalDevice.physical_device, m_SupportsMemoryBudget);
+	m_pUploadManager = std::make_unique<UploadManager>(*this);
+
+	// -- Unified Memory --
+	// Integrated GPUs, resizable BAR and CPU implementations can map their main device local heap.
+	// The 256 MiB BAR window of other discrete GPUs is left alone, it is too small to hold everything that would go there.
+	const VkPhysicalDeviceMemoryProperties& memoryProperties = m_pMemoryAllocator->GetMemoryProperties();
+	VkDeviceSize largestDeviceHeap{};
+	for (uint32_t heap{}; heap < memoryProperties.memoryHeapCount; ++heap)
+	{
+		if (memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			largestDeviceHeap = std::max(largestDeviceHeap, memoryProperties.memoryHeaps[heap].size);
+	}
+	constexpr VkMemoryPropertyFlags HOST_VISIBLE_DEVICE = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	for (uint32_t type{}; type < memoryProperties.memoryTypeCount; ++type)
+	{
+		const VkMemoryType& memoryType = memoryProperties.memoryTypes[type];
+		if ((memoryType.propertyFlags & HOST_VISIBLE_DEVICE) == HOST_VISIBLE_DEVICE
+			&& memoryProperties.memoryHeaps[memoryType.heapIndex].size == largestDeviceHeap)
+			m_HostVisibleDeviceMemory = true;
+	}
+
+	// -- Pipeline Cache --
+	// Lives next to the executable's working directory like the shaders, a stale or foreign file is ignored
+	m_pPipelineCache = std::make_unique<PipelineCache>(m_VkbDevice.device, m_VkbPhysicalDevice.physical_device, "pipeline_cache.bin");
+	m_pShaderModuleCache = std::make_unique<ShaderModuleCache>(m_VkbDevice.device);
+	m_pPipelineLibraryCache = std::make_unique<PipelineLibraryCache>(m_VkbDevice.device);
+
 	auto size = window->GetFramebufferSize();
+	if (m_IsHeadless)
+	{
+		CreateOffscreenTargets(size);
+		return;
+	}
+
+	VkSurfaceFormatKHR format{ VK_FORMAT_B8G8R8A8_SRGB , VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
     auto swap_ret = vkb::SwapchainBuilder(m_VkbDevice, m_Surface)
         .set_desired_format(format)
         .set_desired_min_image_count(2)
@@ -79,23 +159,27 @@ ashen::VulkanContext::VulkanContext(Window* window)
         .build();
     if (!swap_ret) throw std::runtime_error("Failed to create swapchain");
     m_VkbSwapchain = swap_ret.value();
+	m_vSwapchainImages = m_VkbSwapchain.get_images().value();
 	m_vSwapchainImageViews = m_VkbSwapchain.get_image_views().value();
-
-	VkCommandPoolCreateInfo poolInfo{};
-	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-	poolInfo.queueFamilyIndex = GetQueueIndex(vkb::QueueType::graphics);
-
-	vkCreateCommandPool(m_VkbDevice.device, &poolInfo, nullptr, &m_CommandPool);
 }
 ashen::VulkanContext::~VulkanContext()
 {
 	vkDeviceWaitIdle(m_VkbDevice.device);
+	m_vOffscreenImages.clear();
 	vkDestroyCommandPool(m_VkbDevice.device, m_CommandPool, nullptr);
-	m_VkbSwapchain.destroy_image_views(m_vSwapchainImageViews);
-    vkb::destroy_swapchain(m_VkbSwapchain);
+	m_pPipelineLibraryCache.reset();
+	m_pShaderModuleCache.reset();
+	m_pPipelineCache.reset();
+	m_pUploadManager.reset();
+	m_pMemoryAllocator.reset();
+	if (!m_IsHeadless)
+	{
+		m_VkbSwapchain.destroy_image_views(m_vSwapchainImageViews);
+		vkb::destroy_swapchain(m_VkbSwapchain);
+	}
     vkb::destroy_device(m_VkbDevice);
-    vkb::destroy_surface(m_VkbInstance, m_Surface);
+	if (!m_IsHeadless)
+		vkb::destroy_surface(m_VkbInstance, m_Surface);
     vkb::destroy_instance(m_VkbInstance);
 }
 
@@ -106,19 +190,39 @@ VkInstance ashen::VulkanContext::GetInstance()                     const   { ret
 VkDevice ashen::VulkanContext::GetDevice()                         const   { return m_VkbDevice.device; }
 VkPhysicalDevice ashen::VulkanContext::GetPhysicalDevice()         const   { return m_VkbPhysicalDevice.physical_device; }
 VkCommandPool ashen::VulkanContext::GetCommandPool()			   const   { return m_CommandPool; }
+const VkPhysicalDeviceFeatures& ashen::VulkanContext::GetEnabledFeatures() const { return m_VkbPhysicalDevice.features; }
+ashen::MemoryAllocator& ashen::VulkanContext::GetMemoryAllocator() const { return *m_pMemoryAllocator; }
+ashen::UploadManager& ashen::VulkanContext::GetUploadManager()     const   { return *m_pUploadManager; }
+bool ashen::VulkanContext::HasHostVisibleDeviceMemory()             const   { return m_HostVisibleDeviceMemory; }
+ashen::PipelineCache& ashen::VulkanContext::GetPipelineCache()     const   { return *m_pPipelineCache; }
+ashen::ShaderModuleCache& ashen::VulkanContext::GetShaderModuleCache() const { return *m_pShaderModuleCache; }
+ashen::PipelineLibraryCache& ashen::VulkanContext::GetPipelineLibraryCache() const { return *m_pPipelineLibraryCache; }
+bool ashen::VulkanContext::SupportsPipelineLibrary()                const   { return m_SupportsPipelineLibrary; }
+bool ashen::VulkanContext::SupportsMemoryBudget()                   const   { return m_SupportsMemoryBudget; }
 
 //--------------------------------------------------
 //    Queue Objects
 //--------------------------------------------------
 VkQueue ashen::VulkanContext::GetQueue(vkb::QueueType type)        const   { return m_VkbDevice.get_queue(type).value(); }
 uint32_t ashen::VulkanContext::GetQueueIndex(vkb::QueueType type)  const   { return m_VkbDevice.get_queue_index(type).value(); }
+bool ashen::VulkanContext::HasTransferQueue()                       const   { return m_VkbDevice.get_queue_index(vkb::QueueType::transfer).has_value(); }
+std::mutex& ashen::VulkanContext::GetQueueMutex()                   const   { return m_QueueMutex; }
 
 //--------------------------------------------------
 //    Swapchain Objects
 //--------------------------------------------------
 void ashen::VulkanContext::RebuildSwapchain(glm::uvec2 size)
 {
-	vkDeviceWaitIdle(m_VkbDevice.device);
+	{
+		std::lock_guard lock{ m_QueueMutex };
+		vkDeviceWaitIdle(m_VkbDevice.device);
+	}
+
+	if (m_IsHeadless)
+	{
+		CreateOffscreenTargets(size);
+		return;
+	}
 
 	m_VkbSwapchain.destroy_image_views(m_vSwapchainImageViews);
 	m_vSwapchainImageViews.clear();
@@ -129,16 +233,80 @@ void ashen::VulkanContext::RebuildSwapchain(glm::uvec2 size)
 	if (!swap_ret) throw std::runtime_error("Failed to create swapchain");
 	vkb::destroy_swapchain(m_VkbSwapchain);
 	m_VkbSwapchain = swap_ret.value();
+	m_vSwapchainImages = m_VkbSwapchain.get_images().value();
 	m_vSwapchainImageViews = m_VkbSwapchain.get_image_views().value();
 }
 VkSwapchainKHR ashen::VulkanContext::GetSwapchain()                const   { return m_VkbSwapchain.swapchain; }
-uint32_t ashen::VulkanContext::GetSwapchainImageCount()            const   { return m_VkbSwapchain.image_count; }
-std::vector<VkImage> ashen::VulkanContext::GetSwapchainImages()            { return m_VkbSwapchain.get_images().value(); }
-std::vector<VkImageView> ashen::VulkanContext::GetSwapchainImageViews()    { return m_vSwapchainImageViews; }
-VkExtent2D ashen::VulkanContext::GetSwapchainExtent()              const   { return m_VkbSwapchain.extent; }
-VkFormat ashen::VulkanContext::GetSwapchainFormat()                const   { return m_VkbSwapchain.image_format; }
+uint32_t ashen::VulkanContext::GetSwapchainImageCount() const
+{
+	if (m_IsHeadless) return static_cast<uint32_t>(m_vOffscreenImages.size());
+	return m_VkbSwapchain.image_count;
+}
+std::vector<VkImage> ashen::VulkanContext::GetSwapchainImages()
+{
+	if (!m_IsHeadless) return m_vSwapchainImages;
+
+	std::vector<VkImage> vImages{};
+	vImages.reserve(m_vOffscreenImages.size());
+	for (const Image& image : m_vOffscreenImages)
+		vImages.push_back(image.GetHandle());
+	return vImages;
+}
+std::vector<VkImageView> ashen::VulkanContext::GetSwapchainImageViews()
+{
+	if (!m_IsHeadless) return m_vSwapchainImageViews;
+
+	std::vector<VkImageView> vViews{};
+	vViews.reserve(m_vOffscreenImages.size());
+	for (const Image& image : m_vOffscreenImages)
+		vViews.push_back(image.GetView());
+	return vViews;
+}
+VkExtent2D ashen::VulkanContext::GetSwapchainExtent() const
+{
+	if (!m_IsHeadless) return m_VkbSwapchain.extent;
+
+	const VkExtent3D extent = m_vOffscreenImages.front().GetExtent();
+	return { extent.width, extent.height };
+}
+VkFormat ashen::VulkanContext::GetSwapchainFormat() const
+{
+	if (!m_IsHeadless) return m_VkbSwapchain.image_format;
+	return m_vOffscreenImages.front().GetFormat();
+}
 
 //--------------------------------------------------
 //    Other Objects
 //--------------------------------------------------
 VkSurfaceKHR ashen::VulkanContext::GetSurface() const { return m_Surface; }
+bool ashen::VulkanContext::IsHeadless() const { return m_IsHeadless; }
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+void ashen::VulkanContext::CreateOffscreenTargets(glm::uvec2 size)
+{
+	// Mirrors the swapchain (sRGB format) so the Renderer does not need to know where it is drawing to
+	// Without an acquire to wait on, there is one image per frame in flight so an image is never drawn to while still in use
+	const auto format = Image::FindSupportedFormat(GetPhysicalDevice(),
+		{ VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB },
+		VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+
+	m_vOffscreenImages.clear();
+	m_vOffscreenImages.resize(m_OffscreenImageCount);
+	for (Image& image : m_vOffscreenImages)
+	{
+		ImageBuilder imageBuilder{ *this };
+		imageBuilder
+			.SetWidth(size.x)
+			.SetHeight(size.y)
+			.SetTiling(VK_IMAGE_TILING_OPTIMAL)
+			.SetFormat(format)
+			.SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
+			.SetViewType(VK_IMAGE_VIEW_TYPE_2D)
+			.SetUsageFlags(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+			.SetMemoryTag(MemoryTag::RenderTarget)
+			.Build(image);
+	}
+}
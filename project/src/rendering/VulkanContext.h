@@ -5,9 +5,25 @@
 #include <VkBootstrap.h>
 #include <vulkan/vulkan.h>
 
+// -- Standard Library --
+#include <memory>
+#include <mutex>
+#include <vector>
+
 // -- Ashen Includes --
+#include "Image.h"
 #include "Window.h"
 
+// -- Forward Declarations --
+namespace ashen
+{
+    class MemoryAllocator;
+    class PipelineCache;
+    class PipelineLibraryCache;
+    class ShaderModuleCache;
+    class UploadManager;
+}
+
 namespace ashen
 {
     //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -19,7 +35,7 @@ namespace ashen
         //--------------------------------------------------
 		//    Constructor & Destructor
 		//--------------------------------------------------
-        VulkanContext(Window* window);
+        VulkanContext(Window* window, uint32_t offscreenImageCount = 2);
         ~VulkanContext();
 
         VulkanContext(const VulkanContext& other) = delete;
@@ -34,12 +50,24 @@ namespace ashen
         VkDevice GetDevice() const;
         VkPhysicalDevice GetPhysicalDevice() const;
         VkCommandPool GetCommandPool() const;
+        const VkPhysicalDeviceFeatures& GetEnabledFeatures() const;
+        MemoryAllocator& GetMemoryAllocator() const;
+        UploadManager& GetUploadManager() const;
+        bool HasHostVisibleDeviceMemory() const;
+        PipelineCache& GetPipelineCache() const;
+        ShaderModuleCache& GetShaderModuleCache() const;
+        PipelineLibraryCache& GetPipelineLibraryCache() const;
+        bool SupportsPipelineLibrary() const;
+        bool SupportsMemoryBudget() const;
 
         //--------------------------------------------------
 		//    Queue Objects
 		//--------------------------------------------------
         VkQueue GetQueue(vkb::QueueType type) const;
         uint32_t GetQueueIndex(vkb::QueueType type) const;
+        bool HasTransferQueue() const;
+        // Uploads may submit from any thread, every submit, present & device wait goes through this lock
+        std::mutex& GetQueueMutex() const;
 
         //--------------------------------------------------
 		//    Swapchain Objects
@@ -56,15 +84,34 @@ namespace ashen
 		//    Other Objects
 		//--------------------------------------------------
         VkSurfaceKHR GetSurface() const;
+        bool IsHeadless() const;
 
     private:
+        void CreateOffscreenTargets(glm::uvec2 size);
+
         vkb::Instance m_VkbInstance;
         vkb::Device m_VkbDevice;
         vkb::PhysicalDevice m_VkbPhysicalDevice;
         vkb::Swapchain m_VkbSwapchain;
         VkSurfaceKHR m_Surface{};
+        std::vector<VkImage> m_vSwapchainImages{};
         std::vector<VkImageView> m_vSwapchainImageViews{};
         VkCommandPool m_CommandPool{};
+        std::unique_ptr<MemoryAllocator> m_pMemoryAllocator{};
+        std::unique_ptr<UploadManager> m_pUploadManager{};
+        std::unique_ptr<PipelineCache> m_pPipelineCache{};
+        std::unique_ptr<ShaderModuleCache> m_pShaderModuleCache{};
+        std::unique_ptr<PipelineLibraryCache> m_pPipelineLibraryCache{};
+        bool m_SupportsPipelineLibrary{};
+        bool m_SupportsMemoryBudget{};
+        bool m_HostVisibleDeviceMemory{};
+        mutable std::mutex m_QueueMutex{};
+
+        // -- Headless --
+        // Without a window there is no surface or swapchain, the "swapchain" images are then plain offscreen images
+        bool m_IsHeadless{};
+        uint32_t m_OffscreenImageCount{};
+        std::vector<Image> m_vOffscreenImages{};
     };
 }
 
@@ -0,0 +1,147 @@
+// -- Standard Library --
+#include <algorithm>
+#include <iterator>
+
+// -- Ashen Includes --
+#include "AttachmentPool.h"
+#include "Image.h"
+#include "VulkanContext.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  AttachmentPool
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::AttachmentPool::AttachmentPool(VulkanContext& context, uint32_t framesInFlight)
+	: m_pContext{ &context }
+	, m_FramesInFlight{ framesInFlight }
+{}
+ashen::AttachmentPool::~AttachmentPool() = default;
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+const ashen::Image& ashen::AttachmentPool::Acquire(const Desc& desc, uint64_t frameIndex)
+{
+	const auto it = std::find_if(m_vEntries.begin(), m_vEntries.end(), [&desc](const Entry& entry)
+	{
+		return Matches(entry.desc, desc);
+	});
+	if (it != m_vEntries.end())
+	{
+		it->lastUsedFrame = frameIndex;
+		return *it->pImage;
+	}
+
+	// -- Released before, the slot only tells images apart while they are in use --
+	const auto freeIt = std::find_if(m_vFreeEntries.begin(), m_vFreeEntries.end(), [&desc](const Entry& entry)
+	{
+		return MatchesExceptSlot(entry.desc, desc);
+	});
+	if (freeIt != m_vFreeEntries.end())
+	{
+		Entry entry = std::move(*freeIt);
+		m_vFreeEntries.erase(freeIt);
+		entry.desc.slot = desc.slot;
+		entry.lastUsedFrame = frameIndex;
+		m_vEntries.push_back(std::move(entry));
+		return *m_vEntries.back().pImage;
+	}
+
+	// -- Nothing matches, a new image --
+	constexpr VkImageUsageFlags ATTACHMENT_USAGE = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+	const bool transient = (desc.usage & ~ATTACHMENT_USAGE) == 0;
+	const bool depth = (desc.usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) != 0;
+
+	// Free images that only differ in extent are left over from before a resize
+	std::erase_if(m_vFreeEntries, [&desc](const Entry& entry)
+	{
+		return entry.desc.format == desc.format && entry.desc.usage == desc.usage && entry.desc.tag == desc.tag;
+	});
+	++m_Generation;
+
+	Entry entry{};
+	entry.desc = desc;
+	entry.pImage = std::make_unique<Image>();
+	entry.lastUsedFrame = frameIndex;
+	entry.transient = transient;
+
+	ImageBuilder imageBuilder{ *m_pContext };
+	imageBuilder
+		.SetWidth(desc.extent.width)
+		.SetHeight(desc.extent.height)
+		.SetTiling(VK_IMAGE_TILING_OPTIMAL)
+		.SetFormat(desc.format)
+		.SetAspectFlags(depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT)
+		.SetViewType(VK_IMAGE_VIEW_TYPE_2D)
+		.SetUsageFlags(desc.usage)
+		.SetTransient(transient)
+		.SetMemoryTag(desc.tag)
+		.Build(*entry.pImage);
+
+	m_vEntries.push_back(std::move(entry));
+	return *m_vEntries.back().pImage;
+}
+void ashen::AttachmentPool::ReleaseUnused(uint64_t frameIndex)
+{
+	// Frames complete in order, a fence waited on for this frame's slot means every frame up to frameIndex - framesInFlight is done
+	const auto unused = std::partition(m_vEntries.begin(), m_vEntries.end(), [this, frameIndex](const Entry& entry)
+	{
+		return entry.lastUsedFrame + m_FramesInFlight > frameIndex;
+	});
+	std::move(unused, m_vEntries.end(), std::back_inserter(m_vFreeEntries));
+	m_vEntries.erase(unused, m_vEntries.end());
+
+	// -- Oldest released first --
+	if (m_vFreeEntries.size() > MAX_FREE_ENTRIES)
+	{
+		m_vFreeEntries.erase(m_vFreeEntries.begin(), m_vFreeEntries.end() - MAX_FREE_ENTRIES);
+		++m_Generation;
+	}
+}
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+ashen::AttachmentPool::Stats ashen::AttachmentPool::GetStats() const
+{
+	const auto isTransient = [](const Entry& entry)
+	{
+		return entry.transient;
+	};
+
+	Stats stats{};
+	stats.imageCount = static_cast<uint32_t>(m_vEntries.size() + m_vFreeEntries.size());
+	stats.transientCount = static_cast<uint32_t>(std::count_if(m_vEntries.begin(), m_vEntries.end(), isTransient)
+		+ std::count_if(m_vFreeEntries.begin(), m_vFreeEntries.end(), isTransient));
+	stats.freeCount = static_cast<uint32_t>(m_vFreeEntries.size());
+	return stats;
+}
+uint64_t ashen::AttachmentPool::GetGeneration() const
+{
+	return m_Generation;
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+bool ashen::AttachmentPool::Matches(const Desc& a, const Desc& b)
+{
+	return a.format == b.format
+		&& a.extent.width == b.extent.width
+		&& a.extent.height == b.extent.height
+		&& a.usage == b.usage
+		&& a.tag == b.tag
+		&& a.slot == b.slot;
+}
+bool ashen::AttachmentPool::MatchesExceptSlot(const Desc& a, const Desc& b)
+{
+	Desc other = b;
+	other.slot = a.slot;
+	return Matches(a, other);
+}
@@ -0,0 +1,102 @@
+#ifndef ASHEN_ATTACHMENT_POOL_H
+#define ASHEN_ATTACHMENT_POOL_H
+
+// -- Standard Library --
+#include <memory>
+#include <vector>
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Ashen Includes --
+#include "MemoryAllocator.h"
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class Image;
+	class VulkanContext;
+}
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  AttachmentPool
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Hands out render graph attachments by description instead of owning one per frame in flight.
+	// The same description returns the same image for as long as it is asked for, so a resize to the same extent allocates nothing.
+	// Images nobody asked for in the last frames in flight are kept aside, their frames are done with them by then.
+	// A later description that matches in everything but the slot takes them back, so toggling a pass off & on allocates nothing either.
+	//
+	// Attachments that are only ever rendered to (no sampling or copies) are created transient,
+	// in lazily allocated memory when the device has it, so tile based GPUs never have to back them with memory at all.
+	class AttachmentPool final
+	{
+	public:
+		struct Desc
+		{
+			VkFormat format{};
+			VkExtent2D extent{};
+			VkImageUsageFlags usage{};
+			MemoryTag tag{ MemoryTag::Other };
+			uint32_t slot{};                // Images with the same description that are used at the same time ask for different slots
+		};
+		struct Stats
+		{
+			uint32_t imageCount{};
+			uint32_t transientCount{};
+			uint32_t freeCount{};           // Kept aside, part of the image count
+		};
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit AttachmentPool(VulkanContext& context, uint32_t framesInFlight);
+		~AttachmentPool();
+
+		AttachmentPool(const AttachmentPool& other) = delete;
+		AttachmentPool(AttachmentPool&& other) noexcept = delete;
+		AttachmentPool& operator=(const AttachmentPool& other) = delete;
+		AttachmentPool& operator=(AttachmentPool&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// The image is shared by every frame that asks for the same description, import it with the stages of its last use chained.
+		// Per frame in flight attachments ask for the frame's slot instead, its fence already covers the last use.
+		const Image& Acquire(const Desc& desc, uint64_t frameIndex);
+
+		// Only call once the fence of the frame has been waited on, anything the older frames alone used is kept aside
+		void ReleaseUnused(uint64_t frameIndex);
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		Stats GetStats() const;
+		// Changes whenever an image is created or destroyed, a pointer kept from an older generation may be dangling or reused
+		uint64_t GetGeneration() const;
+
+	private:
+		struct Entry
+		{
+			Desc desc{};
+			std::unique_ptr<Image> pImage{};
+			uint64_t lastUsedFrame{};
+			bool transient{};
+		};
+
+		VulkanContext* m_pContext{};
+		uint32_t m_FramesInFlight{};
+		std::vector<Entry> m_vEntries{};
+		std::vector<Entry> m_vFreeEntries{};
+		uint64_t m_Generation{};
+
+		// Free images of other extents are superseded by a resize, the rest is only destroyed when there are too many
+		static constexpr size_t MAX_FREE_ENTRIES{ 8 };
+
+		static bool Matches(const Desc& a, const Desc& b);
+		static bool MatchesExceptSlot(const Desc& a, const Desc& b);
+	};
+}
+
+#endif // ASHEN_ATTACHMENT_POOL_H
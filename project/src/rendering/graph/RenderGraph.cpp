@@ -0,0 +1,341 @@
+// -- Standard Library --
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "RenderGraph.h"
+#include "Image.h"
+#include "SecondaryCommandRecorder.h"
+#include "VulkanContext.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  RenderGraph
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::RenderGraph::RenderGraph(VulkanContext& context)
+	: m_pContext{ &context }
+{}
+
+
+//--------------------------------------------------
+//    Resources
+//--------------------------------------------------
+ashen::RenderGraph::ResourceHandle ashen::RenderGraph::ImportImage(const std::string& name, VkImage image, VkImageView view,
+	VkFormat format, VkExtent2D extent, VkImageAspectFlags aspect,
+	VkImageLayout initialLayout, VkPipelineStageFlags2 initialStage, VkImageLayout finalLayout, VkAccessFlags2 initialAccess)
+{
+	m_vResources.push_back(
+		{
+			.name = name,
+			.image = image,
+			.view = view,
+			.format = format,
+			.extent = extent,
+			.aspect = aspect,
+			.finalLayout = finalLayout,
+
+			.layout = initialLayout,
+			.writeStages = initialStage,
+			.writeAccess = initialAccess,
+			.readStages = VK_PIPELINE_STAGE_2_NONE,
+			.readAccess = VK_ACCESS_2_NONE
+		});
+	return static_cast<ResourceHandle>(m_vResources.size() - 1);
+}
+ashen::RenderGraph::ResourceHandle ashen::RenderGraph::ImportImage(const std::string& name, const Image& image,
+	VkImageLayout initialLayout, VkImageLayout finalLayout, VkPipelineStageFlags2 initialStage, VkAccessFlags2 initialAccess)
+{
+	const VkExtent3D extent = image.GetExtent();
+	const VkImageAspectFlags aspect = image.HasDepthComponent()
+		? VK_IMAGE_ASPECT_DEPTH_BIT | (image.HasStencilComponent() ? VK_IMAGE_ASPECT_STENCIL_BIT : 0)
+		: VK_IMAGE_ASPECT_COLOR_BIT;
+
+	return ImportImage(name, image.GetHandle(), image.GetView(), image.GetFormat(), { extent.width, extent.height },
+		aspect, initialLayout, initialStage, finalLayout, initialAccess);
+}
+
+
+//--------------------------------------------------
+//    Passes
+//--------------------------------------------------
+ashen::RenderGraph::PassBuilder ashen::RenderGraph::AddPass(const std::string& name)
+{
+	return PassBuilder{ *this, name };
+}
+
+
+//--------------------------------------------------
+//    Execution
+//--------------------------------------------------
+void ashen::RenderGraph::Execute(VkCommandBuffer cmd, SecondaryCommandRecorder* pRecorder)
+{
+	// -- Hand all secondary recordings to the workers up front, they record while the primary walks the passes --
+	std::vector<std::vector<std::future<VkCommandBuffer>>> vSecondaries(m_vPasses.size());
+	if (pRecorder)
+	{
+		for (size_t i{}; i < m_vPasses.size(); ++i)
+			RecordSecondaries(m_vPasses[i], *pRecorder, vSecondaries[i]);
+	}
+
+	std::vector<VkCommandBuffer> vCommandBuffers{};
+	for (size_t i{}; i < m_vPasses.size(); ++i)
+	{
+		const Pass& pass = m_vPasses[i];
+		for (const Usage& usage : pass.vUsages)
+			AddBarrier(m_vResources[usage.resource], usage);
+		FlushBarriers(cmd);
+
+		const bool rendering = !pass.vColorAttachments.empty() || pass.hasDepthAttachment;
+		const bool secondary = !vSecondaries[i].empty();
+		if (rendering) BeginRendering(cmd, pass, secondary ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0);
+		if (secondary)
+		{
+			vCommandBuffers.clear();
+			for (std::future<VkCommandBuffer>& future : vSecondaries[i])
+				vCommandBuffers.push_back(future.get());
+			vkCmdExecuteCommands(cmd, static_cast<uint32_t>(vCommandBuffers.size()), vCommandBuffers.data());
+		}
+		else
+		{
+			for (const ExecuteFunc& execute : pass.vExecutes)
+				execute(cmd);
+		}
+		if (rendering) vkCmdEndRendering(cmd);
+	}
+
+	// -- Hand the images over in the layout their next user expects (present, copy, ...) --
+	for (Resource& resource : m_vResources)
+	{
+		if (resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == resource.layout)
+			continue;
+
+		AddBarrier(resource,
+			{
+				.resource = 0,
+				.layout = resource.finalLayout,
+				.stages = VK_PIPELINE_STAGE_2_NONE,
+				.access = VK_ACCESS_2_NONE,
+				.write = false
+			});
+	}
+	FlushBarriers(cmd);
+}
+void ashen::RenderGraph::Reset()
+{
+	// Capacity is kept, the graph is rebuilt with the same shape every frame
+	m_vResources.clear();
+	m_vPasses.clear();
+	m_vBarriers.clear();
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+void ashen::RenderGraph::AddBarrier(Resource& resource, const Usage& usage)
+{
+	const bool layoutChange = usage.layout != resource.layout;
+
+	// -- Read after read in the same layout, or a read of something that was never written: nothing to wait on --
+	if (!usage.write && !layoutChange)
+	{
+		const bool alreadyVisible = (resource.readStages & usage.stages) == usage.stages && (resource.readAccess & usage.access) == usage.access;
+		const bool pendingWrite = resource.writeStages != VK_PIPELINE_STAGE_2_NONE || resource.writeAccess != VK_ACCESS_2_NONE;
+		resource.readStages |= usage.stages;
+		resource.readAccess |= usage.access;
+		if (alreadyVisible || !pendingWrite)
+			return;
+	}
+
+	VkImageMemoryBarrier2 barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = resource.image;
+	barrier.subresourceRange =
+	{
+		.aspectMask = resource.aspect,
+		.baseMipLevel = 0, .levelCount = 1,
+		.baseArrayLayer = 0, .layerCount = 1
+	};
+	barrier.oldLayout = resource.layout;
+	barrier.newLayout = usage.layout;
+	barrier.dstStageMask = usage.stages;
+	barrier.dstAccessMask = usage.access;
+
+	// Writes and layout transitions have to wait for every earlier access (WAW & WAR), reads only for the last write (RAW)
+	if (usage.write || layoutChange)
+	{
+		barrier.srcStageMask = resource.writeStages | resource.readStages;
+		barrier.srcAccessMask = resource.writeAccess;
+	}
+	else
+	{
+		barrier.srcStageMask = resource.writeStages;
+		barrier.srcAccessMask = resource.writeAccess;
+	}
+	m_vBarriers.push_back(barrier);
+
+	// -- Track --
+	resource.layout = usage.layout;
+	if (usage.write)
+	{
+		resource.writeStages = usage.stages;
+		resource.writeAccess = usage.access;
+		resource.readStages = VK_PIPELINE_STAGE_2_NONE;
+		resource.readAccess = VK_ACCESS_2_NONE;
+	}
+	else if (layoutChange)
+	{
+		// The transition itself is the last write, later reads in other stages only need to follow it
+		resource.writeStages = usage.stages;
+		resource.writeAccess = VK_ACCESS_2_NONE;
+		resource.readStages = usage.stages;
+		resource.readAccess = usage.access;
+	}
+}
+void ashen::RenderGraph::FlushBarriers(VkCommandBuffer cmd)
+{
+	if (m_vBarriers.empty())
+		return;
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_vBarriers.size());
+	dependencyInfo.pImageMemoryBarriers = m_vBarriers.data();
+	vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+	m_vBarriers.clear();
+}
+void ashen::RenderGraph::BeginRendering(VkCommandBuffer cmd, const Pass& pass, VkRenderingFlags flags) const
+{
+	auto toAttachmentInfo = [this](const Attachment& attachment, VkImageLayout layout)
+	{
+		VkRenderingAttachmentInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		info.imageView = m_vResources[attachment.resource].view;
+		info.imageLayout = layout;
+		info.loadOp = attachment.loadOp;
+		info.storeOp = attachment.storeOp;
+		info.clearValue = attachment.clearValue;
+		return info;
+	};
+
+	constexpr uint32_t MAX_COLOR_ATTACHMENTS = 8;
+	if (pass.vColorAttachments.size() > MAX_COLOR_ATTACHMENTS)
+		throw std::runtime_error("Too many Color Attachments in Render Graph Pass: " + pass.name);
+
+	VkRenderingAttachmentInfo colorAttachments[MAX_COLOR_ATTACHMENTS]{};
+	for (size_t i{}; i < pass.vColorAttachments.size(); ++i)
+		colorAttachments[i] = toAttachmentInfo(pass.vColorAttachments[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+	VkRenderingAttachmentInfo depthAttachment{};
+	if (pass.hasDepthAttachment)
+		depthAttachment = toAttachmentInfo(pass.depthAttachment, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+
+	// -- Render area is the first attachment, all attachments of a pass are expected to match --
+	const ResourceHandle first = pass.vColorAttachments.empty() ? pass.depthAttachment.resource : pass.vColorAttachments.front().resource;
+
+	VkRenderingInfo renderingInfo{};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+	renderingInfo.flags = flags;
+	renderingInfo.renderArea.offset = { 0, 0 };
+	renderingInfo.renderArea.extent = m_vResources[first].extent;
+	renderingInfo.layerCount = 1;
+	renderingInfo.colorAttachmentCount = static_cast<uint32_t>(pass.vColorAttachments.size());
+	renderingInfo.pColorAttachments = colorAttachments;
+	renderingInfo.pDepthAttachment = pass.hasDepthAttachment ? &depthAttachment : nullptr;
+
+	vkCmdBeginRendering(cmd, &renderingInfo);
+}
+void ashen::RenderGraph::RecordSecondaries(const Pass& pass, SecondaryCommandRecorder& recorder, std::vector<std::future<VkCommandBuffer>>& vSecondaries) const
+{
+	// Secondaries can only continue a rendering instance, passes without attachments are recorded inline
+	if (pass.vColorAttachments.empty() && !pass.hasDepthAttachment)
+		return;
+
+	SecondaryRenderingFormats formats{ .vColorFormats = {}, .depthFormat = VK_FORMAT_UNDEFINED };
+	for (const Attachment& attachment : pass.vColorAttachments)
+		formats.vColorFormats.push_back(m_vResources[attachment.resource].format);
+	if (pass.hasDepthAttachment)
+		formats.depthFormat = m_vResources[pass.depthAttachment.resource].format;
+
+	for (const ExecuteFunc& execute : pass.vExecutes)
+		vSecondaries.push_back(recorder.Record(formats, execute));
+}
+
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  PassBuilder
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, const std::string& name)
+	: m_pGraph{ &graph }
+	, m_Pass{ .name = name, .vUsages = {}, .vColorAttachments = {}, .hasDepthAttachment = false, .depthAttachment = {}, .vExecutes = {} }
+{}
+
+
+//--------------------------------------------------
+//    Builder
+//--------------------------------------------------
+ashen::RenderGraph::PassBuilder& ashen::RenderGraph::PassBuilder::WriteColor(ResourceHandle resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor)
+{
+	VkAccessFlags2 access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+	if (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) access |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT;
+
+	m_Pass.vUsages.push_back(
+		{
+			.resource = resource,
+			.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.access = access,
+			.write = true
+		});
+
+	VkClearValue clearValue{};
+	clearValue.color = clearColor;
+	m_Pass.vColorAttachments.push_back({ .resource = resource, .loadOp = loadOp, .storeOp = VK_ATTACHMENT_STORE_OP_STORE, .clearValue = clearValue });
+	return *this;
+}
+ashen::RenderGraph::PassBuilder& ashen::RenderGraph::PassBuilder::WriteDepth(ResourceHandle resource, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp, float clearDepth)
+{
+	m_Pass.vUsages.push_back(
+		{
+			.resource = resource,
+			.layout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+			.stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+			.access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			.write = true
+		});
+
+	VkClearValue clearValue{};
+	clearValue.depthStencil = { clearDepth, 0 };
+	m_Pass.hasDepthAttachment = true;
+	m_Pass.depthAttachment = { .resource = resource, .loadOp = loadOp, .storeOp = storeOp, .clearValue = clearValue };
+	return *this;
+}
+ashen::RenderGraph::PassBuilder& ashen::RenderGraph::PassBuilder::Sample(ResourceHandle resource, VkPipelineStageFlags2 stages)
+{
+	m_Pass.vUsages.push_back(
+		{
+			.resource = resource,
+			.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			.stages = stages,
+			.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+			.write = false
+		});
+	return *this;
+}
+ashen::RenderGraph::PassBuilder& ashen::RenderGraph::PassBuilder::AddExecute(ExecuteFunc execute)
+{
+	m_Pass.vExecutes.push_back(std::move(execute));
+	return *this;
+}
+void ashen::RenderGraph::PassBuilder::EndPass()
+{
+	m_pGraph->m_vPasses.push_back(std::move(m_Pass));
+}
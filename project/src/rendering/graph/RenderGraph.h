@@ -0,0 +1,146 @@
+#ifndef ASHEN_RENDER_GRAPH_H
+#define ASHEN_RENDER_GRAPH_H
+
+// -- Standard Library --
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class Image;
+	class SecondaryCommandRecorder;
+	class VulkanContext;
+}
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  RenderGraph
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Rebuilt every frame: import the images, add passes that declare what they write and sample, then Execute.
+	// Barriers & layout transitions are derived from those declarations and batched into one vkCmdPipelineBarrier2 per pass.
+	// Passes with attachments are wrapped in a dynamic rendering instance, their callbacks only bind and draw.
+	// Given a recorder, every callback of such a pass is recorded into its own secondary command buffer on a worker thread.
+	class RenderGraph final
+	{
+	public:
+		using ResourceHandle = uint32_t;
+		using ExecuteFunc = std::function<void(VkCommandBuffer)>;
+
+		class PassBuilder;
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit RenderGraph(VulkanContext& context);
+
+		//--------------------------------------------------
+		//    Resources
+		//--------------------------------------------------
+		// initialStage is the stage the image's previous use (or the acquire semaphore wait) is chained to,
+		// initialAccess what that use wrote, so the first write of this frame is ordered after it.
+		// finalLayout is the layout the image is left in after the last pass, UNDEFINED leaves it as the last pass used it.
+		ResourceHandle ImportImage(const std::string& name, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent,
+			VkImageAspectFlags aspect, VkImageLayout initialLayout, VkPipelineStageFlags2 initialStage, VkImageLayout finalLayout,
+			VkAccessFlags2 initialAccess = VK_ACCESS_2_NONE);
+		// Images owned by a frame in flight need no initial stage, images shared between frames chain to the previous frame's use
+		ResourceHandle ImportImage(const std::string& name, const Image& image, VkImageLayout initialLayout, VkImageLayout finalLayout,
+			VkPipelineStageFlags2 initialStage = VK_PIPELINE_STAGE_2_NONE, VkAccessFlags2 initialAccess = VK_ACCESS_2_NONE);
+
+		//--------------------------------------------------
+		//    Passes
+		//--------------------------------------------------
+		PassBuilder AddPass(const std::string& name);
+
+		//--------------------------------------------------
+		//    Execution
+		//--------------------------------------------------
+		void Execute(VkCommandBuffer cmd, SecondaryCommandRecorder* pRecorder = nullptr);
+		void Reset();
+
+	private:
+		struct Resource
+		{
+			std::string name;
+			VkImage image;
+			VkImageView view;
+			VkFormat format;
+			VkExtent2D extent;
+			VkImageAspectFlags aspect;
+			VkImageLayout finalLayout;
+
+			// -- Tracked State --
+			VkImageLayout layout;
+			VkPipelineStageFlags2 writeStages;
+			VkAccessFlags2 writeAccess;
+			VkPipelineStageFlags2 readStages;
+			VkAccessFlags2 readAccess;
+		};
+		struct Usage
+		{
+			ResourceHandle resource;
+			VkImageLayout layout;
+			VkPipelineStageFlags2 stages;
+			VkAccessFlags2 access;
+			bool write;
+		};
+		struct Attachment
+		{
+			ResourceHandle resource;
+			VkAttachmentLoadOp loadOp;
+			VkAttachmentStoreOp storeOp;
+			VkClearValue clearValue;
+		};
+		struct Pass
+		{
+			std::string name;
+			std::vector<Usage> vUsages;
+			std::vector<Attachment> vColorAttachments;
+			bool hasDepthAttachment;
+			Attachment depthAttachment;
+			std::vector<ExecuteFunc> vExecutes;
+		};
+
+		VulkanContext* m_pContext{};
+		std::vector<Resource> m_vResources{};
+		std::vector<Pass> m_vPasses{};
+		std::vector<VkImageMemoryBarrier2> m_vBarriers{};
+
+		void AddBarrier(Resource& resource, const Usage& usage);
+		void FlushBarriers(VkCommandBuffer cmd);
+		void BeginRendering(VkCommandBuffer cmd, const Pass& pass, VkRenderingFlags flags) const;
+		void RecordSecondaries(const Pass& pass, SecondaryCommandRecorder& recorder, std::vector<std::future<VkCommandBuffer>>& vSecondaries) const;
+
+	public:
+		//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+		//? ~~	  PassBuilder
+		//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+		class PassBuilder final
+		{
+		public:
+			PassBuilder& WriteColor(ResourceHandle resource, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearColorValue clearColor = { { 0.f, 0.f, 0.f, 1.f } });
+			PassBuilder& WriteDepth(ResourceHandle resource, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE, float clearDepth = 1.f);
+			PassBuilder& Sample(ResourceHandle resource, VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+			// Callbacks are recorded in the order they were added, each one should be independent of the others' state
+			PassBuilder& AddExecute(ExecuteFunc execute);
+			void EndPass();
+
+		private:
+			explicit PassBuilder(RenderGraph& graph, const std::string& name);
+
+			RenderGraph* m_pGraph;
+			Pass m_Pass;
+
+			friend class RenderGraph;
+		};
+	};
+}
+
+#endif // ASHEN_RENDER_GRAPH_H
@@ -0,0 +1,108 @@
+// -- Standard Library --
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "SecondaryCommandRecorder.h"
+#include "ThreadPool.h"
+#include "VulkanContext.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  SecondaryCommandRecorder
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::SecondaryCommandRecorder::SecondaryCommandRecorder(VulkanContext& context, ThreadPool& threadPool, uint32_t framesInFlight)
+	: m_pContext{ &context }
+	, m_pThreadPool{ &threadPool }
+	, m_ThreadCount{ threadPool.GetThreadCount() }
+{
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_pContext->GetQueueIndex(vkb::QueueType::graphics);
+
+	m_vPools.resize(static_cast<size_t>(framesInFlight) * m_ThreadCount);
+	for (WorkerPool& workerPool : m_vPools)
+	{
+		if (vkCreateCommandPool(m_pContext->GetDevice(), &poolInfo, nullptr, &workerPool.pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create Secondary Command Pool!");
+	}
+}
+ashen::SecondaryCommandRecorder::~SecondaryCommandRecorder()
+{
+	// Destroying a pool frees its buffers along with it
+	for (const WorkerPool& workerPool : m_vPools)
+		vkDestroyCommandPool(m_pContext->GetDevice(), workerPool.pool, nullptr);
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+void ashen::SecondaryCommandRecorder::BeginFrame(uint32_t frame)
+{
+	m_CurrentFrame = frame;
+	for (uint32_t worker{}; worker < m_ThreadCount; ++worker)
+	{
+		WorkerPool& workerPool = m_vPools[frame * m_ThreadCount + worker];
+		vkResetCommandPool(m_pContext->GetDevice(), workerPool.pool, 0);
+		workerPool.used = 0;
+	}
+}
+std::future<VkCommandBuffer> ashen::SecondaryCommandRecorder::Record(const SecondaryRenderingFormats& formats, RecordFunc record)
+{
+	return m_pThreadPool->Submit([this, formats, record = std::move(record)](uint32_t worker)
+	{
+		VkCommandBuffer cmd = AcquireBuffer(worker);
+
+		VkCommandBufferInheritanceRenderingInfo renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+		renderingInfo.colorAttachmentCount = static_cast<uint32_t>(formats.vColorFormats.size());
+		renderingInfo.pColorAttachmentFormats = formats.vColorFormats.data();
+		renderingInfo.depthAttachmentFormat = formats.depthFormat;
+		renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+		renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.pNext = &renderingInfo;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to begin Secondary Command Buffer!");
+		record(cmd);
+		if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+			throw std::runtime_error("Failed to record Secondary Command Buffer!");
+		return cmd;
+	});
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+VkCommandBuffer ashen::SecondaryCommandRecorder::AcquireBuffer(uint32_t worker)
+{
+	// Only ever called from the worker itself, its pool is not touched by anyone else while the frame records
+	WorkerPool& workerPool = m_vPools[m_CurrentFrame * m_ThreadCount + worker];
+	if (workerPool.used == workerPool.vBuffers.size())
+	{
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = workerPool.pool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer cmd{};
+		if (vkAllocateCommandBuffers(m_pContext->GetDevice(), &allocInfo, &cmd) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate Secondary Command Buffer!");
+		workerPool.vBuffers.push_back(cmd);
+	}
+	return workerPool.vBuffers[workerPool.used++];
+}
@@ -0,0 +1,78 @@
+#ifndef ASHEN_SECONDARY_COMMAND_RECORDER_H
+#define ASHEN_SECONDARY_COMMAND_RECORDER_H
+
+// -- Standard Library --
+#include <functional>
+#include <future>
+#include <vector>
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class ThreadPool;
+	class VulkanContext;
+}
+
+namespace ashen
+{
+	// -- Attachment formats of the rendering instance a secondary command buffer continues --
+	struct SecondaryRenderingFormats
+	{
+		std::vector<VkFormat> vColorFormats;
+		VkFormat depthFormat;
+	};
+
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  SecondaryCommandRecorder
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Records secondary command buffers on the workers of a thread pool.
+	// Every worker owns one command pool per frame in flight, pools are never shared so no recording ever takes a lock.
+	// A frame's pools are reset as a whole in BeginFrame, its buffers are reused from then on instead of freed.
+	class SecondaryCommandRecorder final
+	{
+	public:
+		using RecordFunc = std::function<void(VkCommandBuffer)>;
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit SecondaryCommandRecorder(VulkanContext& context, ThreadPool& threadPool, uint32_t framesInFlight);
+		~SecondaryCommandRecorder();
+
+		SecondaryCommandRecorder(const SecondaryCommandRecorder& other) = delete;
+		SecondaryCommandRecorder(SecondaryCommandRecorder&& other) noexcept = delete;
+		SecondaryCommandRecorder& operator=(const SecondaryCommandRecorder& other) = delete;
+		SecondaryCommandRecorder& operator=(SecondaryCommandRecorder&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Only call this once the fence of the frame has been waited on
+		void BeginFrame(uint32_t frame);
+
+		// The returned buffer continues a rendering instance with the given formats, execute it with vkCmdExecuteCommands.
+		// Everything the callback touches has to stay alive and unchanged until the future is ready.
+		std::future<VkCommandBuffer> Record(const SecondaryRenderingFormats& formats, RecordFunc record);
+
+	private:
+		struct WorkerPool
+		{
+			VkCommandPool pool;
+			std::vector<VkCommandBuffer> vBuffers;
+			uint32_t used;
+		};
+
+		VulkanContext* m_pContext{};
+		ThreadPool* m_pThreadPool{};
+		uint32_t m_ThreadCount{};
+		uint32_t m_CurrentFrame{};
+		std::vector<WorkerPool> m_vPools{};             // [frame * threadCount + worker]
+
+		VkCommandBuffer AcquireBuffer(uint32_t worker);
+	};
+}
+
+#endif // ASHEN_SECONDARY_COMMAND_RECORDER_H
@@ -1,6 +1,7 @@
 ﻿// -- Ashen Includes --
 #include "Buffer.h"
 #include "Image.h"
+#include "UploadManager.h"
 #include "VulkanContext.h"
 
 //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -14,7 +15,7 @@ ashen::Buffer::~Buffer()
 {
 	if (!m_pContext) return;
 	vkDestroyBuffer(m_pContext->GetDevice(), m_Buffer, nullptr);
-	vkFreeMemory(m_pContext->GetDevice(), m_Memory, nullptr);
+	m_pContext->GetMemoryAllocator().Free(m_Allocation);
 }
 
 //--------------------------------------------------
@@ -26,12 +27,16 @@ const VkBuffer& ashen::Buffer::GetHandle() const
 }
 const VkDeviceMemory& ashen::Buffer::GetMemoryHandle() const
 {
-	return m_Memory;
+	return m_Allocation.memory;
 }
 VkDeviceSize ashen::Buffer::Size() const
 {
 	return m_Size;
 }
+void* ashen::Buffer::GetMappedData() const
+{
+	return m_Allocation.pMapped;
+}
 
 //--------------------------------------------------
 //    Commands
@@ -75,10 +80,10 @@ void ashen::Buffer::CopyToBuffer(VkCommandBuffer cmd, const Buffer& dst, VkDevic
 	copyRegion.size = size;
 	vkCmdCopyBuffer(cmd, m_Buffer, dst.GetHandle(), 1, &copyRegion);
 }
-void ashen::Buffer::CopyToImage(VkCommandBuffer cmd, const Image& dst, VkExtent3D extent) const
+void ashen::Buffer::CopyToImage(VkCommandBuffer cmd, const Image& dst, VkExtent3D extent, VkDeviceSize srcOffset) const
 {
 	VkBufferImageCopy region{};
-	region.bufferOffset = 0;
+	region.bufferOffset = srcOffset;
 	region.bufferRowLength = 0;
 	region.bufferImageHeight = 0;
 	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -92,10 +97,10 @@ void ashen::Buffer::CopyToImage(VkCommandBuffer cmd, const Image& dst, VkExtent3
 }
 void ashen::Buffer::MapData(const void* pData, uint32_t size) const
 {
-	void* data = nullptr;
-	vkMapMemory(m_pContext->GetDevice(), m_Memory, 0, VK_WHOLE_SIZE, 0, &data);
-	memcpy(data, pData, size);
-	vkUnmapMemory(m_pContext->GetDevice(), m_Memory);
+	// Host visible memory stays mapped for as long as it is allocated
+	if (!m_Allocation.pMapped)
+		throw std::runtime_error("Buffer is not host visible!");
+	memcpy(m_Allocation.pMapped, pData, size);
 }
 
 
@@ -142,6 +147,11 @@ ashen::BufferAllocator& ashen::BufferAllocator::HostAccess(bool access)
 	m_Properties = access ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	return *this;
 }
+ashen::BufferAllocator& ashen::BufferAllocator::SetMemoryTag(MemoryTag tag)
+{
+	m_Tag = tag;
+	return *this;
+}
 ashen::BufferAllocator& ashen::BufferAllocator::AddInitialData(void* data, VkDeviceSize dstOffset, uint32_t size)
 {
 	m_UseInitialData = true;
@@ -157,80 +167,62 @@ ashen::BufferAllocator& ashen::BufferAllocator::AddInitialData(void* data, VkDev
 void ashen::BufferAllocator::Allocate(Buffer& buffer)
 {
 	buffer.m_pContext = m_pContext;
+	MemoryAllocator& memoryAllocator = m_pContext->GetMemoryAllocator();
+
+	// -- Direct Writes --
+	// Where device local memory is host visible as well (integrated GPUs, resizable BAR, CPU implementations),
+	// initial data is written straight into the buffer and the staging copy is skipped
+	constexpr VkMemoryPropertyFlags DIRECT_PROPERTIES = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	VkMemoryPropertyFlags properties = m_Properties;
+	const bool writeDirectly = m_UseInitialData && properties == VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		&& m_pContext->HasHostVisibleDeviceMemory()
+		&& memoryAllocator.HasMemoryType(GetMemoryRequirements().memoryTypeBits, DIRECT_PROPERTIES);
+	if (writeDirectly)
+		properties = DIRECT_PROPERTIES;
+
+	// -- Filled on the transfer queue, which may be another family than the one using the buffer --
+	VkBufferCreateInfo createInfo = m_CreateInfo;
+	if (m_UseInitialData && !writeDirectly && !m_pContext->GetUploadManager().GetSharedQueueFamilies().empty())
+	{
+		const std::vector<uint32_t>& vSharedFamilies = m_pContext->GetUploadManager().GetSharedQueueFamilies();
+		createInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		createInfo.queueFamilyIndexCount = static_cast<uint32_t>(vSharedFamilies.size());
+		createInfo.pQueueFamilyIndices = vSharedFamilies.data();
+	}
 
-	if (vkCreateBuffer(m_pContext->GetDevice(), &m_CreateInfo, nullptr, &buffer.m_Buffer) != VK_SUCCESS)
+	if (vkCreateBuffer(m_pContext->GetDevice(), &createInfo, nullptr, &buffer.m_Buffer) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create Buffer!");
 
 	VkMemoryRequirements memRequirements;
 	vkGetBufferMemoryRequirements(m_pContext->GetDevice(), buffer.m_Buffer, &memRequirements);
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-
-	VkPhysicalDeviceMemoryProperties memProperties;
-	vkGetPhysicalDeviceMemoryProperties(m_pContext->GetPhysicalDevice(), &memProperties);
-	uint32_t outcome = 0;
-	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-	{
-		if ((memRequirements.memoryTypeBits & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & m_Properties) == m_Properties)
-		{
-			outcome = i;
-			break;
-		}
-	}
-	allocInfo.memoryTypeIndex = outcome;
-
-	if (vkAllocateMemory(m_pContext->GetDevice(), &allocInfo, nullptr, &buffer.m_Memory) != VK_SUCCESS)
-		throw std::runtime_error("Failed to allocate Vertex Buffer Memory!");
-
-	vkBindBufferMemory(m_pContext->GetDevice(), buffer.m_Buffer, buffer.m_Memory, 0);
+	buffer.m_Allocation = memoryAllocator.Allocate(memRequirements, properties, true, m_Tag);
+	vkBindBufferMemory(m_pContext->GetDevice(), buffer.m_Buffer, buffer.m_Allocation.memory, buffer.m_Allocation.offset);
 
 	buffer.m_Size = m_CreateInfo.size;
 
-	if (m_UseInitialData)
+	if (!m_UseInitialData)
+		return;
+	UploadManager& uploads = m_pContext->GetUploadManager();
+	if (writeDirectly)
 	{
-		Buffer stagingBuffer;
-		BufferAllocator stagingAllocator{ *m_pContext };
-		stagingAllocator
-			.SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
-			.SetSize(m_InitDataSize)
-			.HostAccess(true)
-			.Allocate(stagingBuffer);
-
-		void* data = nullptr;
-		vkMapMemory(m_pContext->GetDevice(), stagingBuffer.m_Memory, 0, VK_WHOLE_SIZE, 0, &data);
-		memcpy(data, m_pData, m_InitDataSize);
-		vkUnmapMemory(m_pContext->GetDevice(), stagingBuffer.m_Memory);
-
-		VkCommandBufferAllocateInfo allocInfoCmd{};
-		allocInfoCmd.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfoCmd.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfoCmd.commandPool = m_pContext->GetCommandPool();
-		allocInfoCmd.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(m_pContext->GetDevice(), &allocInfoCmd, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
-		{
-			stagingBuffer.CopyToBuffer(commandBuffer, buffer, m_InitDataSize, 0, m_DstOffset);
-		}
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(m_pContext->GetQueue(vkb::QueueType::graphics), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(m_pContext->GetQueue(vkb::QueueType::graphics));
-
-		vkFreeCommandBuffers(m_pContext->GetDevice(), m_pContext->GetCommandPool(), 1, &commandBuffer);
+		memcpy(static_cast<std::byte*>(buffer.m_Allocation.pMapped) + m_DstOffset, m_pData, m_InitDataSize);
+		uploads.RecordDirectWrite(m_InitDataSize);
+		return;
 	}
-}
 
+	// Batched with the other uploads, users wait on the upload timeline before reading the buffer
+	uploads.UploadToBuffer(buffer, m_pData, m_InitDataSize, m_DstOffset);
+}
+VkMemoryRequirements ashen::BufferAllocator::GetMemoryRequirements() const
+{
+	// Memory types only depend on the usage and flags of a buffer, so they are known before it is created
+	VkDeviceBufferMemoryRequirements requirementsInfo{};
+	requirementsInfo.sType = VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS;
+	requirementsInfo.pCreateInfo = &m_CreateInfo;
+
+	VkMemoryRequirements2 requirements{};
+	requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+	vkGetDeviceBufferMemoryRequirements(m_pContext->GetDevice(), &requirementsInfo, &requirements);
+	return requirements.memoryRequirements;
+}
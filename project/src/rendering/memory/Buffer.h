@@ -7,6 +7,9 @@
 // -- Vulkan Includes --
 #include <vulkan/vulkan.h>
 
+// -- Ashen Includes --
+#include "MemoryAllocator.h"
+
 // -- Forward Declares ))
 namespace ashen
 {
@@ -39,17 +42,18 @@ namespace ashen
 		const VkBuffer& GetHandle() const;
 		const VkDeviceMemory& GetMemoryHandle() const;
 		VkDeviceSize Size() const;
+		void* GetMappedData() const;    // Null unless the buffer is host visible
 
 		//--------------------------------------------------
 		//    Commands
 		//--------------------------------------------------
 		void InsertBarrier(VkCommandBuffer cmd, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage) const;
 		void CopyToBuffer(VkCommandBuffer cmd, const Buffer& dst, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset) const;
-		void CopyToImage(VkCommandBuffer cmd, const Image& dst, VkExtent3D extent) const;
+		void CopyToImage(VkCommandBuffer cmd, const Image& dst, VkExtent3D extent, VkDeviceSize srcOffset = 0) const;
 		void MapData(const void* pData, uint32_t size) const;
 
 	private:
-		VkDeviceMemory m_Memory;
+		MemoryAllocation m_Allocation{};
 		VkBuffer m_Buffer;
 		VkDeviceSize m_Size;
 
@@ -76,11 +80,14 @@ namespace ashen
 		BufferAllocator& SetUsage(VkBufferUsageFlags usage);
 		BufferAllocator& SetSharingMode(VkSharingMode sharingMode);
 		BufferAllocator& HostAccess(bool access);
+		BufferAllocator& SetMemoryTag(MemoryTag tag);
 		BufferAllocator& AddInitialData(void* data, VkDeviceSize dstOffset, uint32_t size);
 
 		void Allocate(Buffer& buffer);
 
 	private:
+		VkMemoryRequirements GetMemoryRequirements() const;
+
 		bool m_UseInitialData{};
 		void* m_pData{};
 		uint32_t m_InitDataSize{};
@@ -89,47 +96,9 @@ namespace ashen
 		VulkanContext* m_pContext{};
 
 		VkMemoryPropertyFlags m_Properties{};
+		MemoryTag m_Tag{ MemoryTag::Other };
 		VkBufferCreateInfo m_CreateInfo{};
 	};
-
-	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	//? ~~	  UBO	
-	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-	template<typename UBOType>
-	class UniformBufferGroup final
-	{
-	public:
-		//--------------------------------------------------
-		//    Constructor & Destructor
-		//--------------------------------------------------
-		explicit UniformBufferGroup() = default;
-		UniformBufferGroup(VulkanContext& pContext, uint32_t count)
-		{
-			m_vBuffers.resize(count);
-			for (auto& ubo : m_vBuffers)
-			{
-				BufferAllocator builder{ pContext };
-				builder
-					.SetUsage(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
-					.HostAccess(true)
-					.SetSize(sizeof(UBOType))
-					.Allocate(ubo);
-			}
-		}
-
-
-		//--------------------------------------------------
-		//    Functionality
-		//--------------------------------------------------
-		Buffer& operator[](uint32_t idx)
-		{
-			return m_vBuffers[idx];
-		}
-
-
-	private:
-		std::vector<Buffer> m_vBuffers{};
-	};
 }
 
 #endif // ASHEN_BUFFER_H
@@ -1,8 +1,13 @@
 // -- Ashen Includes --
 #include "Image.h"
 #include "Buffer.h"
+#include "UploadManager.h"
 #include "VulkanContext.h"
 
+// -- Standard Library --
+#include <algorithm>
+#include <cstring>
+
 //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //? ~~	  Image	
 //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -11,11 +16,21 @@
 //    Constructor & Destructor
 //--------------------------------------------------
 ashen::Image::~Image()
+{
+	Destroy();
+}
+void ashen::Image::Destroy()
 {
 	if (!m_pContext) return;
 	vkDestroyImageView(m_pContext->GetDevice(), m_ImageView, nullptr);
 	vkDestroyImage(m_pContext->GetDevice(), m_Image, nullptr);
-	vkFreeMemory(m_pContext->GetDevice(), m_ImageMemory, nullptr);
+	m_pContext->GetMemoryAllocator().Free(m_Allocation);
+
+	m_ImageView = VK_NULL_HANDLE;
+	m_Image = VK_NULL_HANDLE;
+	m_Allocation = {};
+	m_CurrentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	m_pContext = nullptr;
 }
 
 //--------------------------------------------------
@@ -35,6 +50,29 @@ VkFormat ashen::Image::FindSupportedFormat(VkPhysicalDevice physicalDevice, cons
 
 	throw std::runtime_error("Failed to find Supported Format!");
 }
+uint32_t ashen::Image::GetTexelSize(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+	case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+	case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+	case VK_FORMAT_D32_SFLOAT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+		return 4;
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return 5;
+	case VK_FORMAT_R16G16B16A16_SFLOAT:
+		return 8;
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+		return 16;
+	default:
+		return 0;
+	}
+}
 
 
 //--------------------------------------------------
@@ -62,6 +100,10 @@ VkImageLayout ashen::Image::GetCurrentLayout() const
 {
 	return m_CurrentLayout;
 }
+VkSharingMode ashen::Image::GetSharingMode() const
+{
+	return m_ImageInfo.sharingMode;
+}
 bool ashen::Image::HasStencilComponent() const
 {
 	switch (m_ImageInfo.format)
@@ -93,6 +135,57 @@ bool ashen::Image::HasDepthComponent() const
 //    Commands
 //--------------------------------------------------
 void ashen::Image::TransitionLayout(VkCommandBuffer cmd, VkImageLayout newLayout, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage)
+{
+	const VkImageMemoryBarrier2 barrier = CreateBarrier(newLayout, srcAccess, srcStage, dstAccess, dstStage);
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.dependencyFlags = 0;
+	dependencyInfo.pNext = nullptr;
+	dependencyInfo.memoryBarrierCount = 0;
+	dependencyInfo.pMemoryBarriers = nullptr;
+	dependencyInfo.bufferMemoryBarrierCount = 0;
+	dependencyInfo.pBufferMemoryBarriers = nullptr;
+	dependencyInfo.imageMemoryBarrierCount = 1;
+	dependencyInfo.pImageMemoryBarriers = &barrier;
+
+	vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+
+	m_CurrentLayout = newLayout;
+}
+void ashen::Image::InsertBarrier(VkCommandBuffer cmd, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage,	VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage)
+{
+	TransitionLayout(cmd, m_CurrentLayout, srcAccess, srcStage, dstAccess, dstStage);
+}
+VkImageMemoryBarrier2 ashen::Image::ReleaseOwnership(VkCommandBuffer cmd, VkImageLayout newLayout,
+	VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage, uint32_t srcFamily,
+	VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage, uint32_t dstFamily)
+{
+	// -- Both halves name the same families & layouts, each only the stages of its own queue --
+	VkImageMemoryBarrier2 release = CreateBarrier(newLayout, srcAccess, srcStage, 0, VK_PIPELINE_STAGE_2_NONE);
+	release.srcQueueFamilyIndex = srcFamily;
+	release.dstQueueFamilyIndex = dstFamily;
+
+	VkImageMemoryBarrier2 acquire = CreateBarrier(newLayout, 0, VK_PIPELINE_STAGE_2_NONE, dstAccess, dstStage);
+	acquire.srcQueueFamilyIndex = srcFamily;
+	acquire.dstQueueFamilyIndex = dstFamily;
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.imageMemoryBarrierCount = 1;
+	dependencyInfo.pImageMemoryBarriers = &release;
+	vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+
+	m_CurrentLayout = newLayout;
+	return acquire;
+}
+VkImageMemoryBarrier2 ashen::Image::DeferTransition(VkImageLayout newLayout, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage)
+{
+	const VkImageMemoryBarrier2 barrier = CreateBarrier(newLayout, srcAccess, srcStage, dstAccess, dstStage);
+	m_CurrentLayout = newLayout;
+	return barrier;
+}
+VkImageMemoryBarrier2 ashen::Image::CreateBarrier(VkImageLayout newLayout, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage) const
 {
 	VkImageMemoryBarrier2 barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
@@ -121,25 +214,7 @@ void ashen::Image::TransitionLayout(VkCommandBuffer cmd, VkImageLayout newLayout
 	barrier.subresourceRange.levelCount = 1;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
-
-	VkDependencyInfo dependencyInfo{};
-	dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-	dependencyInfo.dependencyFlags = 0;
-	dependencyInfo.pNext = nullptr;
-	dependencyInfo.memoryBarrierCount = 0;
-	dependencyInfo.pMemoryBarriers = nullptr;
-	dependencyInfo.bufferMemoryBarrierCount = 0;
-	dependencyInfo.pBufferMemoryBarriers = nullptr;
-	dependencyInfo.imageMemoryBarrierCount = 1;
-	dependencyInfo.pImageMemoryBarriers = &barrier;
-
-	vkCmdPipelineBarrier2(cmd, &dependencyInfo);
-
-	m_CurrentLayout = newLayout;
-}
-void ashen::Image::InsertBarrier(VkCommandBuffer cmd, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage,	VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage)
-{
-	TransitionLayout(cmd, m_CurrentLayout, srcAccess, srcStage, dstAccess, dstStage);
+	return barrier;
 }
 
 
@@ -232,6 +307,16 @@ ashen::ImageBuilder& ashen::ImageBuilder::SetViewType(VkImageViewType viewType)
 	m_ViewType = viewType;
 	return *this;
 }
+ashen::ImageBuilder& ashen::ImageBuilder::SetMemoryTag(MemoryTag tag)
+{
+	m_Tag = tag;
+	return *this;
+}
+ashen::ImageBuilder& ashen::ImageBuilder::SetTransient(bool transient)
+{
+	m_Transient = transient;
+	return *this;
+}
 
 // -- Data --
 ashen::ImageBuilder& ashen::ImageBuilder::InitialData(void* data, uint32_t offset, uint32_t width, uint32_t height,	uint32_t dataSize, VkImageLayout finalLayout)
@@ -257,91 +342,93 @@ ashen::ImageBuilder& ashen::ImageBuilder::SetPreMadeImage(VkImage image)
 // -- Build --
 void ashen::ImageBuilder::Build(Image& image) const
 {
+	MemoryAllocator& memoryAllocator = m_pContext->GetMemoryAllocator();
+	VkImageCreateInfo imageInfo = m_ImageInfo;
+
+	// -- Direct Writes --
+	// Linear images in host visible device memory are written in place, their texels keep the preinitialized layout.
+	// Optimal tiling is opaque to the host, those images are always staged.
+	constexpr VkMemoryPropertyFlags DIRECT_PROPERTIES = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	bool writeDirectly = m_UseInitialData && m_PreMadeImage == VK_NULL_HANDLE
+		&& imageInfo.tiling == VK_IMAGE_TILING_LINEAR
+		&& m_pContext->HasHostVisibleDeviceMemory();
+	if (writeDirectly)
+	{
+		VkDeviceImageMemoryRequirements requirementsInfo{};
+		requirementsInfo.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+		requirementsInfo.pCreateInfo = &imageInfo;
+
+		VkMemoryRequirements2 requirements{};
+		requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		vkGetDeviceImageMemoryRequirements(m_pContext->GetDevice(), &requirementsInfo, &requirements);
+		writeDirectly = memoryAllocator.HasMemoryType(requirements.memoryRequirements.memoryTypeBits, DIRECT_PROPERTIES);
+	}
+	if (writeDirectly)
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
+
+	// -- Filled on the transfer queue, which may be another family than the one using the image --
+	if (m_UseInitialData && !writeDirectly && !m_pContext->GetUploadManager().GetSharedQueueFamilies().empty())
+	{
+		const std::vector<uint32_t>& vSharedFamilies = m_pContext->GetUploadManager().GetSharedQueueFamilies();
+		imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(vSharedFamilies.size());
+		imageInfo.pQueueFamilyIndices = vSharedFamilies.data();
+	}
+
+	if (m_Transient)
+		imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
 	image.m_pContext = m_pContext;
-	image.m_ImageInfo = m_ImageInfo;
-	image.m_CurrentLayout = m_ImageInfo.initialLayout;
+	image.m_ImageInfo = imageInfo;
+	image.m_CurrentLayout = imageInfo.initialLayout;
 	image.m_Image = m_PreMadeImage;
 	if (image.m_Image == VK_NULL_HANDLE)
 	{
-		if (vkCreateImage(m_pContext->GetDevice(), &m_ImageInfo, nullptr, &image.m_Image) != VK_SUCCESS)
+		if (vkCreateImage(m_pContext->GetDevice(), &imageInfo, nullptr, &image.m_Image) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create Image!");
 	}
 
 	VkMemoryRequirements memRequirements;
 	vkGetImageMemoryRequirements(m_pContext->GetDevice(), image.m_Image, &memRequirements);
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
+	// -- Transient attachments only get physical memory where the device needs it, most desktop GPUs have no such type --
+	constexpr VkMemoryPropertyFlags LAZY_PROPERTIES = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+	VkMemoryPropertyFlags properties = writeDirectly ? DIRECT_PROPERTIES : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	if (m_Transient && memoryAllocator.HasMemoryType(memRequirements.memoryTypeBits, LAZY_PROPERTIES))
+		properties = LAZY_PROPERTIES;
+
+	const bool linear = m_ImageInfo.tiling == VK_IMAGE_TILING_LINEAR;
+	image.m_Allocation = memoryAllocator.Allocate(memRequirements, properties, linear, m_Tag);
+	vkBindImageMemory(m_pContext->GetDevice(), image.m_Image, image.m_Allocation.memory, image.m_Allocation.offset);
 
-	VkPhysicalDeviceMemoryProperties memProperties;
-	vkGetPhysicalDeviceMemoryProperties(m_pContext->GetPhysicalDevice(), &memProperties);
-	uint32_t outcome = 0;
-	VkMemoryPropertyFlags prop = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+	if (writeDirectly)
 	{
-		if ((memRequirements.memoryTypeBits & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & prop) == prop)
-		{
-			outcome = i;
-			break;
-		}
+		// Rows are padded to the pitch of the driver, so they are copied one by one
+		VkImageSubresource subresource{};
+		subresource.aspectMask = m_AspectFlags;
+		VkSubresourceLayout layout{};
+		vkGetImageSubresourceLayout(m_pContext->GetDevice(), image.m_Image, &subresource, &layout);
+
+		const size_t rowSize = m_InitDataSize / std::max(m_InitDataHeight, 1u);
+		const auto* pSource = static_cast<const std::byte*>(m_pData);
+		auto* pDestination = static_cast<std::byte*>(image.m_Allocation.pMapped) + layout.offset;
+		for (uint32_t row{}; row < m_InitDataHeight; ++row)
+			memcpy(pDestination + row * layout.rowPitch, pSource + row * rowSize, rowSize);
+		m_pContext->GetUploadManager().RecordDirectWrite(m_InitDataSize);
 	}
-	allocInfo.memoryTypeIndex = outcome;
-
-	if (vkAllocateMemory(m_pContext->GetDevice(), &allocInfo, nullptr, &image.m_ImageMemory) != VK_SUCCESS)
-		throw std::runtime_error("Failed to allocate Vertex Buffer Memory!");
-
-	vkBindImageMemory(m_pContext->GetDevice(), image.m_Image, image.m_ImageMemory, 0);
-
-
 
-	if (m_UseInitialData)
+	// -- Batched with the other uploads, users wait on the upload timeline before using the image in its final layout --
+	VkAccessFlags2 finalAccess{};
+	VkPipelineStageFlags2 finalStage{};
+	GetLayoutUsage(m_FinalLayout, finalAccess, finalStage);
+	if (writeDirectly)
 	{
-		Buffer stagingBuffer;
-		BufferAllocator stagingAllocator{ *m_pContext };
-		stagingAllocator
-			.SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
-			.HostAccess(true)
-			.SetSize(m_InitDataSize)
-			.Allocate(stagingBuffer);
-
-		void* data = nullptr;
-		vkMapMemory(m_pContext->GetDevice(), stagingBuffer.GetMemoryHandle(), 0, VK_WHOLE_SIZE, 0, &data);
-		memcpy(data, m_pData, m_InitDataSize);
-		vkUnmapMemory(m_pContext->GetDevice(), stagingBuffer.GetMemoryHandle());
-
-		VkCommandBufferAllocateInfo allocInfoCmd{};
-		allocInfoCmd.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfoCmd.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfoCmd.commandPool = m_pContext->GetCommandPool();
-		allocInfoCmd.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(m_pContext->GetDevice(), &allocInfoCmd, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
-		{
-			image.TransitionLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				0, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-				VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
-			stagingBuffer.CopyToImage(commandBuffer, image, VkExtent3D{ m_InitDataWidth, m_InitDataHeight, 1 });
-		}
-		vkEndCommandBuffer(commandBuffer);
-
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(m_pContext->GetQueue(vkb::QueueType::graphics), 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(m_pContext->GetQueue(vkb::QueueType::graphics));
-
-		vkFreeCommandBuffers(m_pContext->GetDevice(), m_pContext->GetCommandPool(), 1, &commandBuffer);
+		if (m_FinalLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+			m_pContext->GetUploadManager().TransitionImage(image, m_FinalLayout, finalAccess, finalStage);
 	}
+	else if (m_UseInitialData)
+		m_pContext->GetUploadManager().UploadToImage(image, m_pData, m_InitDataSize, VkExtent3D{ m_InitDataWidth, m_InitDataHeight, 1 },
+			m_FinalLayout, finalAccess, finalStage);
 
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -357,3 +444,30 @@ void ashen::ImageBuilder::Build(Image& image) const
 	if (vkCreateImageView(m_pContext->GetDevice(), &viewInfo, nullptr, &image.m_ImageView) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create Image View!");
 }
+void ashen::ImageBuilder::GetLayoutUsage(VkImageLayout layout, VkAccessFlags2& access, VkPipelineStageFlags2& stage)
+{
+	switch (layout)
+	{
+	case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+		access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+		stage = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+		access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+		stage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+	case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+		access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		stage = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+		break;
+	case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+		access = VK_ACCESS_2_TRANSFER_READ_BIT;
+		stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+		break;
+	default:
+		access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+		stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		break;
+	}
+}
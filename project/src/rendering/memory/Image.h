@@ -7,6 +7,9 @@
 // -- Vulkan Includes --
 #include <vulkan/vulkan.h>
 
+// -- Ashen Includes --
+#include "MemoryAllocator.h"
+
 // -- Forward Declarations --
 namespace ashen
 {
@@ -32,10 +35,14 @@ namespace ashen
 		Image& operator=(const Image& other) = delete;
 		Image& operator=(Image&& other) noexcept = default;
 
+		void Destroy();
+
 		//--------------------------------------------------
 		//    Helpers
 		//--------------------------------------------------
 		static VkFormat FindSupportedFormat(VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+		// Bytes per texel of the color & depth formats the renderer uses, 0 for any other
+		static uint32_t GetTexelSize(VkFormat format);
 
 		//--------------------------------------------------
 		//    Accessors & Mutators
@@ -46,6 +53,7 @@ namespace ashen
 		VkFormat			GetFormat()						const;
 		VkExtent3D			GetExtent()						const;
 		VkImageLayout		GetCurrentLayout()				const;
+		VkSharingMode		GetSharingMode()				const;
 
 		bool				HasStencilComponent()			const;
 		bool				HasDepthComponent()				const;
@@ -59,17 +67,30 @@ namespace ashen
 		void InsertBarrier(VkCommandBuffer cmd,
 			VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage,
 			VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage);
+		// Queue family ownership transfer of an exclusive image, records the release & returns the matching acquire.
+		// The acquire has to be recorded on the destination family once the release was submitted, the layout changes with the transfer.
+		VkImageMemoryBarrier2 ReleaseOwnership(VkCommandBuffer cmd, VkImageLayout newLayout,
+			VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage, uint32_t srcFamily,
+			VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage, uint32_t dstFamily);
+		// Returns the transition for recording on another command buffer later, the image takes the new layout right away
+		VkImageMemoryBarrier2 DeferTransition(VkImageLayout newLayout,
+			VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage,
+			VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage);
 
 	private:
 		VkImage			m_Image			{ VK_NULL_HANDLE };
 		VkImageView		m_ImageView		{ VK_NULL_HANDLE };
-		VkDeviceMemory	m_ImageMemory	{ VK_NULL_HANDLE };
+		MemoryAllocation m_Allocation	{ };
 
 		VkImageLayout m_CurrentLayout{ VK_IMAGE_LAYOUT_UNDEFINED };
 		VkImageCreateInfo m_ImageInfo{ };
 
 		VulkanContext* m_pContext{};
 
+		VkImageMemoryBarrier2 CreateBarrier(VkImageLayout newLayout,
+			VkAccessFlags2 srcAccess, VkPipelineStageFlags2 srcStage,
+			VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage) const;
+
 		friend class ImageBuilder;
 	};
 
@@ -100,6 +121,9 @@ namespace ashen
 		ImageBuilder& SetCreateFlags(VkImageCreateFlags flags);
 		ImageBuilder& SetAspectFlags(VkImageAspectFlags aspectFlags);
 		ImageBuilder& SetViewType(VkImageViewType viewType);
+		ImageBuilder& SetMemoryTag(MemoryTag tag);
+		// Only for attachments that are never sampled or copied, lazily allocated memory is used when the device has it
+		ImageBuilder& SetTransient(bool transient);
 
 		// -- Data --
 		ImageBuilder& InitialData(void* data, uint32_t offset, uint32_t width, uint32_t height, uint32_t dataSize, VkImageLayout finalLayout);
@@ -120,10 +144,15 @@ namespace ashen
 
 		VkImageAspectFlags m_AspectFlags{};
 		VkImageViewType m_ViewType{};
+		MemoryTag m_Tag{ MemoryTag::Other };
+		bool m_Transient{};
 
 		VkImage m_PreMadeImage{};
 		VkImageCreateInfo m_ImageInfo{};
 		VulkanContext* m_pContext{};
+
+		// How the final layout is used, the upload makes its data visible to that
+		static void GetLayoutUsage(VkImageLayout layout, VkAccessFlags2& access, VkPipelineStageFlags2& stage);
 	};
 }
 
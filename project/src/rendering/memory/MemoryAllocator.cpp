@@ -0,0 +1,323 @@
+// -- Standard Library --
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "MemoryAllocator.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  MemoryAllocator
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::MemoryAllocator::MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, bool memoryBudget, VkDeviceSize blockSize)
+	: m_Device{ device }
+	, m_PhysicalDevice{ physicalDevice }
+	, m_MemoryBudget{ memoryBudget }
+	, m_BlockSize{ std::bit_ceil(std::max(blockSize, MIN_ALLOCATION_SIZE)) }
+{
+	// Queried once, it never changes for the lifetime of the device
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+	m_MaxOrder = GetOrder(m_BlockSize);
+	m_vPools.resize(m_MemoryProperties.memoryTypeCount * 2);
+	m_vHeapBytes.resize(m_MemoryProperties.memoryHeapCount);
+}
+ashen::MemoryAllocator::~MemoryAllocator()
+{
+	for (const Pool& pool : m_vPools)
+	{
+		for (const auto& pBlock : pool.vBlocks)
+		{
+			if (pBlock) vkFreeMemory(m_Device, pBlock->memory, nullptr);
+		}
+	}
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+ashen::MemoryAllocation ashen::MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, MemoryTag tag)
+{
+	const uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+	const VkDeviceSize size = std::max({ requirements.size, requirements.alignment, MIN_ALLOCATION_SIZE });
+	const uint32_t poolIndex = memoryType * 2 + (linear ? 1 : 0);
+
+	std::lock_guard lock{ m_Mutex };
+	m_TaggedBytes[static_cast<uint32_t>(tag)] += requirements.size;
+
+	// -- Dedicated --
+	// Anything over half a block would waste most of a block on rounding, it gets its own memory instead
+	if (size > m_BlockSize / 2)
+	{
+		MemoryAllocation allocation{};
+		allocation.memory = AllocateMemory(requirements.size, memoryType, &allocation.pMapped);
+		allocation.size = requirements.size;
+		allocation.pool = poolIndex;
+		allocation.dedicated = true;
+		allocation.tag = tag;
+
+		++m_DedicatedCount;
+		m_DedicatedBytes += requirements.size;
+		return allocation;
+	}
+
+	// -- Sub-Allocated --
+	const uint32_t order = GetOrder(size);
+	Pool& pool = m_vPools[poolIndex];
+
+	MemoryAllocation allocation{};
+	allocation.size = requirements.size;
+	allocation.pool = poolIndex;
+	allocation.tag = tag;
+	for (uint32_t blockIndex{}; blockIndex < pool.vBlocks.size(); ++blockIndex)
+	{
+		if (!pool.vBlocks[blockIndex])
+			continue;
+		Block& block = *pool.vBlocks[blockIndex];
+		if (!AllocateFromBlock(block, order, allocation.offset))
+			continue;
+
+		allocation.memory = block.memory;
+		allocation.block = blockIndex;
+		allocation.pMapped = block.pMapped ? static_cast<std::byte*>(block.pMapped) + allocation.offset : nullptr;
+		return allocation;
+	}
+
+	// -- No Room, New Block --
+	auto pBlock = std::make_unique<Block>();
+	pBlock->memory = AllocateMemory(m_BlockSize, memoryType, &pBlock->pMapped);
+	pBlock->vFreeLists.resize(m_MaxOrder + 1);
+	pBlock->vFreeLists[m_MaxOrder].insert(0);
+	AllocateFromBlock(*pBlock, order, allocation.offset);
+
+	// Slots of released blocks are reused, the indices of live allocations have to stay valid
+	const auto freeSlot = std::find(pool.vBlocks.begin(), pool.vBlocks.end(), nullptr);
+	allocation.memory = pBlock->memory;
+	allocation.block = static_cast<uint32_t>(freeSlot - pool.vBlocks.begin());
+	allocation.pMapped = pBlock->pMapped ? static_cast<std::byte*>(pBlock->pMapped) + allocation.offset : nullptr;
+	if (freeSlot != pool.vBlocks.end()) *freeSlot = std::move(pBlock);
+	else pool.vBlocks.push_back(std::move(pBlock));
+	return allocation;
+}
+void ashen::MemoryAllocator::Free(const MemoryAllocation& allocation)
+{
+	if (allocation.memory == VK_NULL_HANDLE)
+		return;
+
+	std::lock_guard lock{ m_Mutex };
+	m_TaggedBytes[static_cast<uint32_t>(allocation.tag)] -= allocation.size;
+
+	if (allocation.dedicated)
+	{
+		FreeMemory(allocation.memory, allocation.size, allocation.pool / 2);
+		--m_DedicatedCount;
+		m_DedicatedBytes -= allocation.size;
+		return;
+	}
+
+	// -- Merge with the buddy for as long as it is free as well --
+	Block& block = *m_vPools[allocation.pool].vBlocks[allocation.block];
+	const auto it = block.allocatedOrders.find(allocation.offset);
+	if (it == block.allocatedOrders.end())
+		throw std::runtime_error("Freed memory that was not allocated from this block!");
+
+	uint32_t order = it->second;
+	VkDeviceSize offset = allocation.offset;
+	block.allocatedOrders.erase(it);
+	block.usedBytes -= MIN_ALLOCATION_SIZE << order;
+
+	while (order < m_MaxOrder)
+	{
+		const VkDeviceSize buddy = offset ^ (MIN_ALLOCATION_SIZE << order);
+		if (block.vFreeLists[order].erase(buddy) == 0)
+			break;
+		offset = std::min(offset, buddy);
+		++order;
+	}
+	block.vFreeLists[order].insert(offset);
+
+	// -- Empty blocks are released, but one is kept around per pool so resizing does not hit the driver every time --
+	if (block.usedBytes != 0)
+		return;
+	Pool& pool = m_vPools[allocation.pool];
+	const bool hasOtherEmptyBlock = std::any_of(pool.vBlocks.begin(), pool.vBlocks.end(), [&block](const auto& pOther)
+	{
+		return pOther && pOther.get() != &block && pOther->usedBytes == 0;
+	});
+	if (hasOtherEmptyBlock)
+	{
+		FreeMemory(block.memory, m_BlockSize, allocation.pool / 2);
+		pool.vBlocks[allocation.block].reset();
+	}
+}
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+uint32_t ashen::MemoryAllocator::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const
+{
+	for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+	{
+		if ((typeBits & (1u << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			return i;
+	}
+	throw std::runtime_error("Failed to find a suitable Memory Type!");
+}
+bool ashen::MemoryAllocator::HasMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const
+{
+	for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+	{
+		if ((typeBits & (1u << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			return true;
+	}
+	return false;
+}
+const VkPhysicalDeviceMemoryProperties& ashen::MemoryAllocator::GetMemoryProperties() const
+{
+	return m_MemoryProperties;
+}
+ashen::MemoryAllocator::Stats ashen::MemoryAllocator::GetStats() const
+{
+	std::lock_guard lock{ m_Mutex };
+
+	Stats stats{};
+	stats.dedicatedCount = m_DedicatedCount;
+	stats.allocationCount = m_DedicatedCount;
+	stats.reservedBytes = m_DedicatedBytes;
+	stats.usedBytes = m_DedicatedBytes;
+	stats.taggedBytes = m_TaggedBytes;
+
+	VkDeviceSize largestRangesBytes{};
+	for (const Pool& pool : m_vPools)
+	{
+		for (const auto& pBlock : pool.vBlocks)
+		{
+			if (!pBlock)
+				continue;
+			++stats.blockCount;
+			stats.allocationCount += static_cast<uint32_t>(pBlock->allocatedOrders.size());
+			stats.reservedBytes += m_BlockSize;
+			stats.usedBytes += pBlock->usedBytes;
+
+			// The highest non-empty order of a block is its largest free range
+			for (uint32_t order = m_MaxOrder + 1; order-- > 0;)
+			{
+				if (pBlock->vFreeLists[order].empty())
+					continue;
+				largestRangesBytes += MIN_ALLOCATION_SIZE << order;
+				stats.largestFreeRange = std::max(stats.largestFreeRange, MIN_ALLOCATION_SIZE << order);
+				break;
+			}
+		}
+	}
+
+	// Ranges can never span blocks, so each block is only compared against its own largest free range
+	const VkDeviceSize freeBytes = stats.reservedBytes - stats.usedBytes;
+	if (freeBytes > 0)
+		stats.fragmentation = 1.f - static_cast<float>(largestRangesBytes) / static_cast<float>(freeBytes);
+	return stats;
+}
+std::vector<ashen::MemoryAllocator::HeapStats> ashen::MemoryAllocator::GetHeapStats() const
+{
+	// -- The budget changes with what other processes use, it is queried every time --
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+	budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+	memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	memoryProperties.pNext = &budgetProperties;
+	if (m_MemoryBudget)
+		vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDevice, &memoryProperties);
+
+	std::lock_guard lock{ m_Mutex };
+
+	std::vector<HeapStats> vHeaps(m_MemoryProperties.memoryHeapCount);
+	for (uint32_t heap{}; heap < m_MemoryProperties.memoryHeapCount; ++heap)
+	{
+		HeapStats& stats = vHeaps[heap];
+		stats.size = m_MemoryProperties.memoryHeaps[heap].size;
+		stats.deviceLocal = (m_MemoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+		stats.allocatedBytes = m_vHeapBytes[heap];
+
+		// Without the extension only what went through here is known, 80% of the heap is a safe guess of what the OS allows
+		stats.budget = m_MemoryBudget ? budgetProperties.heapBudget[heap] : stats.size / 10 * 8;
+		stats.usage = m_MemoryBudget ? budgetProperties.heapUsage[heap] : stats.allocatedBytes;
+	}
+	return vHeaps;
+}
+const char* ashen::MemoryAllocator::GetTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MemoryTag::Mesh:			return "Mesh";
+	case MemoryTag::Uniform:		return "Uniform";
+	case MemoryTag::RenderTarget:	return "RenderTarget";
+	case MemoryTag::Depth:			return "Depth";
+	case MemoryTag::Staging:		return "Staging";
+	default:						return "Other";
+	}
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+VkDeviceMemory ashen::MemoryAllocator::AllocateMemory(VkDeviceSize size, uint32_t memoryType, void** ppMapped)
+{
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	VkDeviceMemory memory{};
+	if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+		throw std::runtime_error("Failed to allocate Device Memory!");
+
+	// -- Host visible memory is mapped once for its whole lifetime, a memory object can not be mapped twice --
+	*ppMapped = nullptr;
+	if (m_MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		if (vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, ppMapped) != VK_SUCCESS)
+			throw std::runtime_error("Failed to map Device Memory!");
+	}
+
+	m_vHeapBytes[m_MemoryProperties.memoryTypes[memoryType].heapIndex] += size;
+	return memory;
+}
+void ashen::MemoryAllocator::FreeMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType)
+{
+	vkFreeMemory(m_Device, memory, nullptr);
+	m_vHeapBytes[m_MemoryProperties.memoryTypes[memoryType].heapIndex] -= size;
+}
+bool ashen::MemoryAllocator::AllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset)
+{
+	// -- Smallest free range that fits --
+	uint32_t freeOrder = order;
+	while (freeOrder < block.vFreeLists.size() && block.vFreeLists[freeOrder].empty())
+		++freeOrder;
+	if (freeOrder >= block.vFreeLists.size())
+		return false;
+
+	offset = *block.vFreeLists[freeOrder].begin();
+	block.vFreeLists[freeOrder].erase(block.vFreeLists[freeOrder].begin());
+
+	// -- Split it down, the upper halves stay free --
+	while (freeOrder > order)
+	{
+		--freeOrder;
+		block.vFreeLists[freeOrder].insert(offset + (MIN_ALLOCATION_SIZE << freeOrder));
+	}
+
+	block.allocatedOrders.emplace(offset, order);
+	block.usedBytes += MIN_ALLOCATION_SIZE << order;
+	return true;
+}
+uint32_t ashen::MemoryAllocator::GetOrder(VkDeviceSize size)
+{
+	const VkDeviceSize units = (size + MIN_ALLOCATION_SIZE - 1) / MIN_ALLOCATION_SIZE;
+	return static_cast<uint32_t>(std::bit_width(units - 1));
+}
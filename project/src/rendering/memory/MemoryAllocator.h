@@ -0,0 +1,143 @@
+#ifndef ASHEN_MEMORY_ALLOCATOR_H
+#define ASHEN_MEMORY_ALLOCATOR_H
+
+// -- Standard Library --
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+namespace ashen
+{
+	// -- What an allocation is used for, only for reporting --
+	enum class MemoryTag : uint32_t
+	{
+		Mesh,
+		Uniform,
+		RenderTarget,
+		Depth,
+		Staging,
+		Other
+	};
+	inline constexpr uint32_t MEMORY_TAG_COUNT = 6;
+
+
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  MemoryAllocation
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// A range inside one of the allocator's blocks, or a whole dedicated VkDeviceMemory if it was too large for a block
+	struct MemoryAllocation
+	{
+		VkDeviceMemory memory{ VK_NULL_HANDLE };
+		VkDeviceSize offset{};
+		VkDeviceSize size{};
+		void* pMapped{};                // Host visible memory stays mapped, already offset to the start of the range
+
+		uint32_t pool{};
+		uint32_t block{};
+		bool dedicated{};
+		MemoryTag tag{ MemoryTag::Other };
+	};
+
+
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  MemoryAllocator
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Sub-allocates buffers & images from large blocks with a buddy allocator, so resources no longer cost a vkAllocateMemory each.
+	// Buddies are aligned to their own size, which covers any alignment up to the rounded size of the request.
+	// Linear and optimal resources never share a block, so bufferImageGranularity can not cause aliasing between them.
+	class MemoryAllocator final
+	{
+	public:
+		struct Stats
+		{
+			uint32_t blockCount{};
+			uint32_t dedicatedCount{};
+			uint32_t allocationCount{};
+			VkDeviceSize reservedBytes{};
+			VkDeviceSize usedBytes{};
+			VkDeviceSize largestFreeRange{};
+			float fragmentation{};          // 0 when all free memory is one range, towards 1 the more it is scattered
+			std::array<VkDeviceSize, MEMORY_TAG_COUNT> taggedBytes{};  // Requested bytes per tag, without block rounding
+		};
+		struct HeapStats
+		{
+			VkDeviceSize size{};
+			VkDeviceSize budget{};          // What the process can use before the OS starts evicting or allocations fail
+			VkDeviceSize usage{};           // Everything the process uses, driver internal allocations included
+			VkDeviceSize allocatedBytes{};  // What this allocator took from the heap, blocks & dedicated allocations
+			bool deviceLocal{};
+		};
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		// Without VK_EXT_memory_budget the budget is estimated from the heap sizes and only this allocator's usage is known
+		explicit MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, bool memoryBudget, VkDeviceSize blockSize = 64ull << 20);
+		~MemoryAllocator();
+
+		MemoryAllocator(const MemoryAllocator& other) = delete;
+		MemoryAllocator(MemoryAllocator&& other) noexcept = delete;
+		MemoryAllocator& operator=(const MemoryAllocator& other) = delete;
+		MemoryAllocator& operator=(MemoryAllocator&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Linear covers buffers and linear-tiling images, optimal covers every other image
+		MemoryAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, MemoryTag tag = MemoryTag::Other);
+		void Free(const MemoryAllocation& allocation);
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		uint32_t FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const;
+		bool HasMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const;
+		const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const;
+		Stats GetStats() const;
+		std::vector<HeapStats> GetHeapStats() const;
+		static const char* GetTagName(MemoryTag tag);
+
+	private:
+		static constexpr VkDeviceSize MIN_ALLOCATION_SIZE = 256;
+
+		struct Block
+		{
+			VkDeviceMemory memory{ VK_NULL_HANDLE };
+			void* pMapped{};
+			std::vector<std::set<VkDeviceSize>> vFreeLists{};     // Free offsets per order, order 0 is MIN_ALLOCATION_SIZE
+			std::map<VkDeviceSize, uint32_t> allocatedOrders{};   // Offset -> order of every live allocation
+			VkDeviceSize usedBytes{};
+		};
+		struct Pool
+		{
+			std::vector<std::unique_ptr<Block>> vBlocks{};
+		};
+
+		VkDevice m_Device{};
+		VkPhysicalDevice m_PhysicalDevice{};
+		bool m_MemoryBudget{};
+		VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+		VkDeviceSize m_BlockSize{};
+		uint32_t m_MaxOrder{};
+
+		mutable std::mutex m_Mutex{};
+		std::vector<Pool> m_vPools{};                             // Indexed by memory type * 2 + linear
+		uint32_t m_DedicatedCount{};
+		VkDeviceSize m_DedicatedBytes{};
+		std::array<VkDeviceSize, MEMORY_TAG_COUNT> m_TaggedBytes{};
+		std::vector<VkDeviceSize> m_vHeapBytes{};                 // Indexed by heap
+
+		VkDeviceMemory AllocateMemory(VkDeviceSize size, uint32_t memoryType, void** ppMapped);
+		void FreeMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType);
+		static bool AllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset);
+		static uint32_t GetOrder(VkDeviceSize size);
+	};
+}
+
+#endif // ASHEN_MEMORY_ALLOCATOR_H
@@ -0,0 +1,66 @@
+// -- Standard Library --
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "UniformRingBuffer.h"
+#include "VulkanContext.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  UniformRingBuffer
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::UniformRingBuffer::UniformRingBuffer(VulkanContext& context, uint32_t framesInFlight, VkDeviceSize frameCapacity, VkBufferUsageFlags usage, MemoryTag tag)
+{
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(context.GetPhysicalDevice(), &properties);
+
+	// Dynamic offsets have to be a multiple of the alignment, every slice starts on one as well
+	m_Alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+	m_FrameCapacity = (frameCapacity + m_Alignment - 1) / m_Alignment * m_Alignment;
+
+	BufferAllocator allocator{ context };
+	allocator
+		.SetUsage(usage)
+		.HostAccess(true)
+		.SetMemoryTag(tag)
+		.SetSize(static_cast<uint32_t>(m_FrameCapacity * framesInFlight))
+		.Allocate(m_Buffer);
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+void ashen::UniformRingBuffer::BeginFrame(uint32_t frameIndex)
+{
+	m_FrameBegin = m_FrameCapacity * frameIndex;
+	m_Head = m_FrameBegin;
+}
+uint32_t ashen::UniformRingBuffer::Push(const void* pData, VkDeviceSize size)
+{
+	const VkDeviceSize offset = m_Head;
+	if (offset + size > m_FrameBegin + m_FrameCapacity)
+		throw std::runtime_error("Uniform Ring Buffer is out of space for this frame!");
+
+	memcpy(static_cast<std::byte*>(m_Buffer.GetMappedData()) + offset, pData, size);
+	m_Head = (offset + size + m_Alignment - 1) / m_Alignment * m_Alignment;
+	return static_cast<uint32_t>(offset);
+}
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+const ashen::Buffer& ashen::UniformRingBuffer::GetBuffer() const
+{
+	return m_Buffer;
+}
+VkDeviceSize ashen::UniformRingBuffer::GetFrameCapacity() const
+{
+	return m_FrameCapacity;
+}
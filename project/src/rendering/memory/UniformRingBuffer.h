@@ -0,0 +1,70 @@
+#ifndef ASHEN_UNIFORM_RING_BUFFER_H
+#define ASHEN_UNIFORM_RING_BUFFER_H
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Ashen Includes --
+#include "Buffer.h"
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class VulkanContext;
+}
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  UniformRingBuffer
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// One persistently mapped uniform buffer, split in a slice per frame in flight.
+	// Uniforms are bump-allocated from the slice of the current frame and bound through dynamic offsets,
+	// so descriptor sets are written once and any number of draws can get their own data.
+	// With vertex buffer usage the same works for per-instance data streamed every frame, bound at the returned offset.
+	class UniformRingBuffer final
+	{
+	public:
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit UniformRingBuffer(VulkanContext& context, uint32_t framesInFlight, VkDeviceSize frameCapacity = 64 * 1024,
+			VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, MemoryTag tag = MemoryTag::Uniform);
+		~UniformRingBuffer() = default;
+
+		UniformRingBuffer(const UniformRingBuffer& other) = delete;
+		UniformRingBuffer(UniformRingBuffer&& other) noexcept = delete;
+		UniformRingBuffer& operator=(const UniformRingBuffer& other) = delete;
+		UniformRingBuffer& operator=(UniformRingBuffer&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Only call once the fence of the frame has been waited on, its slice is overwritten from the start
+		void BeginFrame(uint32_t frameIndex);
+
+		// Returns the dynamic offset of the copied data
+		uint32_t Push(const void* pData, VkDeviceSize size);
+		template<typename T>
+		uint32_t Push(const T& data)
+		{
+			return Push(&data, sizeof(T));
+		}
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		const Buffer& GetBuffer() const;
+		VkDeviceSize GetFrameCapacity() const;
+
+	private:
+		Buffer m_Buffer{};
+		VkDeviceSize m_Alignment{};
+		VkDeviceSize m_FrameCapacity{};
+
+		VkDeviceSize m_FrameBegin{};
+		VkDeviceSize m_Head{};
+	};
+}
+
+#endif // ASHEN_UNIFORM_RING_BUFFER_H
@@ -0,0 +1,337 @@
+// -- Standard Library --
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "UploadManager.h"
+#include "Image.h"
+#include "VulkanContext.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  UploadManager
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::UploadManager::UploadManager(VulkanContext& context, VkDeviceSize stagingSize)
+	: m_pContext{ &context }
+{
+	// -- Queue --
+	// A queue family without graphics is a DMA engine on most GPUs, copies there overlap with rendering
+	m_GraphicsFamily = context.GetQueueIndex(vkb::QueueType::graphics);
+	m_QueueFamily = m_GraphicsFamily;
+	m_Queue = context.GetQueue(vkb::QueueType::graphics);
+	if (context.HasTransferQueue())
+	{
+		m_HasTransferQueue = true;
+		m_vSharedQueueFamilies = { m_GraphicsFamily, context.GetQueueIndex(vkb::QueueType::transfer) };
+		m_QueueFamily = context.GetQueueIndex(vkb::QueueType::transfer);
+		m_Queue = context.GetQueue(vkb::QueueType::transfer);
+	}
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_QueueFamily;
+	if (vkCreateCommandPool(context.GetDevice(), &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create Upload Command Pool!");
+
+	// -- Timeline --
+	VkSemaphoreTypeCreateInfo typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+	if (vkCreateSemaphore(context.GetDevice(), &semaphoreInfo, nullptr, &m_Timeline) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create Upload Timeline Semaphore!");
+
+	// -- Ring --
+	// Image copies need their source offset aligned to the texel size, 16 covers every format
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(context.GetPhysicalDevice(), &properties);
+	m_Alignment = std::max<VkDeviceSize>(properties.limits.optimalBufferCopyOffsetAlignment, 16);
+	m_RingSize = (stagingSize + m_Alignment - 1) / m_Alignment * m_Alignment;
+
+	BufferAllocator allocator{ context };
+	allocator
+		.SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+		.HostAccess(true)
+		.SetMemoryTag(MemoryTag::Staging)
+		.SetSize(static_cast<uint32_t>(m_RingSize))
+		.Allocate(m_Ring);
+}
+ashen::UploadManager::~UploadManager()
+{
+	// Batches that were never flushed are dropped, the command pool takes their command buffer with it
+	Wait(m_SubmittedValue);
+	vkDestroyCommandPool(m_pContext->GetDevice(), m_CommandPool, nullptr);
+	vkDestroySemaphore(m_pContext->GetDevice(), m_Timeline, nullptr);
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+uint64_t ashen::UploadManager::UploadToBuffer(const Buffer& dst, const void* pData, VkDeviceSize size, VkDeviceSize dstOffset)
+{
+	std::lock_guard lock{ m_Mutex };
+
+	m_StagedBytes += size;
+	VkDeviceSize srcOffset{};
+	const Buffer& staging = AllocateStaging(pData, size, srcOffset);
+	staging.CopyToBuffer(GetPendingCommandBuffer(), dst, size, srcOffset, dstOffset);
+	return m_SubmittedValue + 1;
+}
+uint64_t ashen::UploadManager::UploadToImage(Image& dst, const void* pData, VkDeviceSize size, VkExtent3D extent,
+	VkImageLayout finalLayout, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage)
+{
+	std::lock_guard lock{ m_Mutex };
+
+	m_StagedBytes += size;
+	VkDeviceSize srcOffset{};
+	const Buffer& staging = AllocateStaging(pData, size, srcOffset);
+	const VkCommandBuffer cmd = GetPendingCommandBuffer();
+	dst.TransitionLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+		VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	staging.CopyToImage(cmd, dst, extent, srcOffset);
+	FinishImage(cmd, dst, finalLayout, dstAccess, dstStage);
+	return m_SubmittedValue + 1;
+}
+void ashen::UploadManager::TransitionImage(Image& dst, VkImageLayout finalLayout, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage)
+{
+	std::lock_guard lock{ m_Mutex };
+
+	// Host writes are visible to everything submitted after them, only the layout has to change
+	m_vPendingBarriers.push_back(dst.DeferTransition(finalLayout, 0, VK_PIPELINE_STAGE_2_NONE, dstAccess, dstStage));
+}
+void ashen::UploadManager::RecordPendingBarriers(VkCommandBuffer cmd)
+{
+	std::lock_guard lock{ m_Mutex };
+	if (m_vPendingBarriers.empty())
+		return;
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_vPendingBarriers.size());
+	dependencyInfo.pImageMemoryBarriers = m_vPendingBarriers.data();
+	vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+	m_vPendingBarriers.clear();
+}
+uint64_t ashen::UploadManager::Flush()
+{
+	std::lock_guard lock{ m_Mutex };
+
+	RetireCompleted(false);
+	if (m_pPending)
+		SubmitPending();
+	return m_SubmittedValue;
+}
+void ashen::UploadManager::Wait(uint64_t value) const
+{
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &m_Timeline;
+	waitInfo.pValues = &value;
+	vkWaitSemaphores(m_pContext->GetDevice(), &waitInfo, UINT64_MAX);
+}
+void ashen::UploadManager::RecordDirectWrite(VkDeviceSize size)
+{
+	std::lock_guard lock{ m_Mutex };
+	m_DirectBytes += size;
+}
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+VkSemaphore ashen::UploadManager::GetTimelineSemaphore() const
+{
+	return m_Timeline;
+}
+bool ashen::UploadManager::HasTransferQueue() const
+{
+	return m_HasTransferQueue;
+}
+const std::vector<uint32_t>& ashen::UploadManager::GetSharedQueueFamilies() const
+{
+	return m_vSharedQueueFamilies;
+}
+ashen::UploadManager::Stats ashen::UploadManager::GetStats() const
+{
+	std::lock_guard lock{ m_Mutex };
+	return Stats{ static_cast<uint32_t>(m_SubmittedValue), m_StagedBytes, m_DirectBytes };
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+VkCommandBuffer ashen::UploadManager::GetPendingCommandBuffer()
+{
+	if (m_pPending)
+		return m_pPending->commandBuffer;
+
+	m_pPending = std::make_unique<Batch>();
+	m_pPending->ringEnd = m_Head;
+	if (m_vFreeCommandBuffers.empty())
+	{
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = m_CommandPool;
+		allocInfo.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(m_pContext->GetDevice(), &allocInfo, &m_pPending->commandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate Upload Command Buffer!");
+	}
+	else
+	{
+		m_pPending->commandBuffer = m_vFreeCommandBuffers.back();
+		m_vFreeCommandBuffers.pop_back();
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(m_pPending->commandBuffer, &beginInfo);
+	return m_pPending->commandBuffer;
+}
+bool ashen::UploadManager::TryAllocateStaging(VkDeviceSize size, VkDeviceSize& offset)
+{
+	// -- An empty ring starts over at the beginning, so the full size is available again --
+	if (m_Head == m_Tail)
+	{
+		m_Head = (m_Head + m_RingSize - 1) / m_RingSize * m_RingSize;
+		m_Tail = m_Head;
+	}
+
+	// -- Ranges never wrap around the end, what does not fit before it starts at the beginning --
+	uint64_t position = (m_Head + m_Alignment - 1) / m_Alignment * m_Alignment;
+	if (position % m_RingSize + size > m_RingSize)
+		position += m_RingSize - position % m_RingSize;
+	if (position + size - m_Tail > m_RingSize)
+		return false;
+
+	offset = position % m_RingSize;
+	m_Head = position + size;
+	return true;
+}
+const ashen::Buffer& ashen::UploadManager::AllocateStaging(const void* pData, VkDeviceSize size, VkDeviceSize& offset)
+{
+	// -- Larger than the whole ring --
+	if (size > m_RingSize)
+	{
+		auto pStaging = std::make_unique<Buffer>();
+		BufferAllocator allocator{ *m_pContext };
+		allocator
+			.SetUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+			.HostAccess(true)
+			.SetMemoryTag(MemoryTag::Staging)
+			.SetSize(static_cast<uint32_t>(size))
+			.Allocate(*pStaging);
+		pStaging->MapData(pData, static_cast<uint32_t>(size));
+
+		offset = 0;
+		GetPendingCommandBuffer();
+		m_pPending->vOversized.push_back(std::move(pStaging));
+		return *m_pPending->vOversized.back();
+	}
+
+	// -- Ring is full, the recorded batch is submitted and the oldest one waited on until there is room --
+	while (!TryAllocateStaging(size, offset))
+	{
+		if (m_pPending)
+			SubmitPending();
+		RetireCompleted(true);
+	}
+
+	GetPendingCommandBuffer();
+	m_pPending->ringEnd = m_Head;
+	memcpy(static_cast<std::byte*>(m_Ring.GetMappedData()) + offset, pData, size);
+	return m_Ring;
+}
+uint64_t ashen::UploadManager::SubmitPending()
+{
+	vkEndCommandBuffer(m_pPending->commandBuffer);
+
+	const uint64_t value = m_SubmittedValue + 1;
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &value;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &m_pPending->commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &m_Timeline;
+
+	// A full ring submits from whatever thread is uploading, possibly while the render thread submits to the same queue
+	std::unique_lock queueLock{ m_pContext->GetQueueMutex() };
+	if (vkQueueSubmit(m_Queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		throw std::runtime_error("Failed to submit Uploads!");
+	queueLock.unlock();
+
+	m_SubmittedValue = value;
+	m_pPending->value = value;
+	m_InFlight.push_back(std::move(*m_pPending));
+	m_pPending.reset();
+	return value;
+}
+void ashen::UploadManager::FinishImage(VkCommandBuffer cmd, Image& dst, VkImageLayout finalLayout, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage)
+{
+	if (finalLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+		finalLayout = dst.GetCurrentLayout();
+
+	// -- Same queue that uses the image --
+	if (!m_HasTransferQueue)
+	{
+		dst.TransitionLayout(cmd, finalLayout,
+			VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+			dstAccess, dstStage);
+		return;
+	}
+
+	// -- Shared between the families, the timeline signal makes the copy available to the graphics queue --
+	if (dst.GetSharingMode() == VK_SHARING_MODE_CONCURRENT)
+	{
+		dst.TransitionLayout(cmd, finalLayout,
+			VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+			0, VK_PIPELINE_STAGE_2_NONE);
+		return;
+	}
+
+	// -- Owned by one family, released here & acquired by the graphics queue --
+	// The acquire waits on everything before it, so it is ordered after the timeline wait whatever stage that is at
+	VkImageMemoryBarrier2 acquire = dst.ReleaseOwnership(cmd, finalLayout,
+		VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_TRANSFER_BIT, m_QueueFamily,
+		dstAccess, dstStage, m_GraphicsFamily);
+	acquire.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	m_vPendingBarriers.push_back(acquire);
+}
+void ashen::UploadManager::RetireCompleted(bool waitForOldest)
+{
+	if (waitForOldest && !m_InFlight.empty())
+		Wait(m_InFlight.front().value);
+
+	uint64_t completed{};
+	vkGetSemaphoreCounterValue(m_pContext->GetDevice(), m_Timeline, &completed);
+	while (!m_InFlight.empty() && m_InFlight.front().value <= completed)
+	{
+		Batch& batch = m_InFlight.front();
+		vkResetCommandBuffer(batch.commandBuffer, 0);
+		m_vFreeCommandBuffers.push_back(batch.commandBuffer);
+
+		// Batches without ring data (only oversized uploads) can end before a tail that already moved on
+		m_Tail = std::max(m_Tail, batch.ringEnd);
+		m_InFlight.pop_front();
+	}
+}
@@ -0,0 +1,134 @@
+#ifndef ASHEN_UPLOAD_MANAGER_H
+#define ASHEN_UPLOAD_MANAGER_H
+
+// -- Standard Library --
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Ashen Includes --
+#include "Buffer.h"
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class Image;
+	class VulkanContext;
+}
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  UploadManager
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Copies initial data to device local resources through one persistently mapped staging ring.
+	// Uploads are recorded into a shared batch and submitted together on Flush, on a transfer queue when the device has one.
+	// Every batch signals a timeline semaphore, submissions that read the uploaded resources wait on its value instead of the CPU.
+	//
+	// Without a transfer queue the batches go to the graphics queue, submits to either take the context's queue lock.
+	// Uploaded images end up in their final layout, exclusive ones are released by the transfer queue and acquired by the
+	// graphics queue through RecordPendingBarriers, before the submission that waits on the upload timeline.
+	class UploadManager final
+	{
+	public:
+		struct Stats
+		{
+			uint32_t batchCount{};
+			uint64_t stagedBytes{};
+			uint64_t directBytes{};         // Written straight into host visible device memory, never went through the ring
+		};
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit UploadManager(VulkanContext& context, VkDeviceSize stagingSize = 32ull << 20);
+		~UploadManager();
+
+		UploadManager(const UploadManager& other) = delete;
+		UploadManager(UploadManager&& other) noexcept = delete;
+		UploadManager& operator=(const UploadManager& other) = delete;
+		UploadManager& operator=(UploadManager&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// The data is copied into the ring right away, it does not have to outlive the call.
+		// Returns the timeline value the copy is done at, once the batch it is in has been flushed.
+		uint64_t UploadToBuffer(const Buffer& dst, const void* pData, VkDeviceSize size, VkDeviceSize dstOffset);
+		// The image is left in finalLayout for dstStage & dstAccess, VK_IMAGE_LAYOUT_UNDEFINED keeps it in the transfer layout
+		uint64_t UploadToImage(Image& dst, const void* pData, VkDeviceSize size, VkExtent3D extent,
+			VkImageLayout finalLayout, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage);
+		// Host written images only need their layout, that is left to the graphics queue together with the acquires
+		void TransitionImage(Image& dst, VkImageLayout finalLayout, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage);
+		// Records the ownership acquires & transitions the graphics queue owes the uploads, before anything uses those images.
+		// The submission has to wait on the value Flush returns after this was called.
+		void RecordPendingBarriers(VkCommandBuffer cmd);
+
+		// Submits the recorded batch, if any, and returns the value the last submitted batch signals
+		uint64_t Flush();
+		void Wait(uint64_t value) const;
+
+		// Initial data that skipped staging is only counted, to show what the direct path saves
+		void RecordDirectWrite(VkDeviceSize size);
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		VkSemaphore GetTimelineSemaphore() const;
+		bool HasTransferQueue() const;
+
+		// Resources that are filled on the transfer queue and used on the graphics queue are shared between both families,
+		// empty if they are the same family and no sharing is needed
+		const std::vector<uint32_t>& GetSharedQueueFamilies() const;
+		Stats GetStats() const;
+
+	private:
+		struct Batch
+		{
+			VkCommandBuffer commandBuffer{};
+			uint64_t value{};
+			uint64_t ringEnd{};                                  // Ring position that is free again once the batch is done
+			std::vector<std::unique_ptr<Buffer>> vOversized{};   // Uploads larger than the ring get their own staging buffer
+		};
+
+		VulkanContext* m_pContext{};
+		VkQueue m_Queue{};
+		uint32_t m_QueueFamily{};
+		uint32_t m_GraphicsFamily{};
+		bool m_HasTransferQueue{};
+		std::vector<uint32_t> m_vSharedQueueFamilies{};
+
+		VkCommandPool m_CommandPool{};
+		std::vector<VkCommandBuffer> m_vFreeCommandBuffers{};
+		VkSemaphore m_Timeline{};
+		uint64_t m_SubmittedValue{};
+
+		// -- Ring --
+		// Head and tail only ever grow, their difference is what is in use and their remainder the offset in the buffer
+		Buffer m_Ring{};
+		VkDeviceSize m_RingSize{};
+		VkDeviceSize m_Alignment{};
+		uint64_t m_Head{};
+		uint64_t m_Tail{};
+
+		mutable std::mutex m_Mutex{};
+		std::unique_ptr<Batch> m_pPending{};
+		std::deque<Batch> m_InFlight{};
+		uint64_t m_StagedBytes{};
+		uint64_t m_DirectBytes{};
+		std::vector<VkImageMemoryBarrier2> m_vPendingBarriers{};
+
+		VkCommandBuffer GetPendingCommandBuffer();
+		bool TryAllocateStaging(VkDeviceSize size, VkDeviceSize& offset);
+		const Buffer& AllocateStaging(const void* pData, VkDeviceSize size, VkDeviceSize& offset);
+		uint64_t SubmitPending();
+		void FinishImage(VkCommandBuffer cmd, Image& dst, VkImageLayout finalLayout, VkAccessFlags2 dstAccess, VkPipelineStageFlags2 dstStage);
+		void RetireCompleted(bool waitForOldest);
+	};
+}
+
+#endif // ASHEN_UPLOAD_MANAGER_H
@@ -163,6 +163,10 @@ const std::vector<VkDescriptorSetLayoutBinding>& ashen::DescriptorSet::GetBindin
 {
 	return m_vLayoutBinding;
 }
+const std::vector<VkDescriptorBindingFlags>& ashen::DescriptorSet::GetBindingFlags() const
+{
+	return m_vBindingFlags;
+}
 
 
 //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -206,6 +210,7 @@ void ashen::DescriptorSetAllocator::Allocate(const DescriptorPool& pool, Descrip
 		vLayoutBindings[i] = el.m_LayoutBindings;
 	}
 	ds.m_vLayoutBinding = vLayoutBindings;
+	ds.m_vBindingFlags = vBindingFlags;
 
 	if (DescriptorSet::vCreatedLayouts.contains(str))
 	{
@@ -128,11 +128,13 @@ namespace ashen
 		const VkDescriptorSet& GetHandle() const;
 		const VkDescriptorSetLayout& GetLayout() const;
 		const std::vector<VkDescriptorSetLayoutBinding>& GetBindings() const;
+		const std::vector<VkDescriptorBindingFlags>& GetBindingFlags() const;
 
 	private:
 		VkDescriptorSet m_DescriptorSet{};
 		VkDescriptorSetLayout m_Layout{};
 		std::vector<VkDescriptorSetLayoutBinding> m_vLayoutBinding{};
+		std::vector<VkDescriptorBindingFlags> m_vBindingFlags{};
 
 		VulkanContext* m_pContext{};
 
@@ -1,9 +1,14 @@
 // -- Standard Library --
+#include <array>
+#include <bit>
+#include <chrono>
 #include <stdexcept>
-#include <fstream>
 
 // -- Ashen Includes --
 #include "Pipeline.h"
+#include "PipelineCache.h"
+#include "PipelineLibraryCache.h"
+#include "ShaderModuleCache.h"
 #include "VulkanContext.h"
 
 //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -46,6 +51,23 @@ void ashen::Pipeline::Destroy()
     if (!m_pContext) return;
     vkDestroyPipelineLayout(m_pContext->GetDevice(), m_Layout, nullptr);
     vkDestroyPipeline(m_pContext->GetDevice(), m_Pipeline, nullptr);
+    vkDestroyPipeline(m_pContext->GetDevice(), m_FastLinkedPipeline, nullptr);
+}
+
+// -- Link Time Optimization --
+bool ashen::Pipeline::IsFastLinked() const
+{
+    return m_vLibraries.front() != VK_NULL_HANDLE && m_FastLinkedPipeline == VK_NULL_HANDLE;
+}
+VkPipeline ashen::Pipeline::CreateOptimized() const
+{
+    const PipelineBuilder builder{ *m_pContext };
+    return builder.LinkLibraries(m_Layout, m_vLibraries, VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT);
+}
+void ashen::Pipeline::SetOptimized(VkPipeline optimized)
+{
+    m_FastLinkedPipeline = m_Pipeline;
+    m_Pipeline = optimized;
 }
 
 //--------------------------------------------------
@@ -185,16 +207,31 @@ ashen::PushConstantRange& ashen::PipelineBuilder::AddPushConstantRange()
 }
 
 // -- Descriptors --
-ashen::PipelineBuilder& ashen::PipelineBuilder::AddDescriptorSet(DescriptorSet& descriptorSetLayout)
+ashen::PipelineBuilder& ashen::PipelineBuilder::AddDescriptorSet(const DescriptorSet& descriptorSetLayout)
 {
     m_vDescriptorLayouts.push_back(descriptorSetLayout.GetLayout());
+
+    // -- What the layout is defined as, its handle says nothing about that & may be reused once it is destroyed --
+    using Key = PipelineLibraryCache;
+    const std::vector<VkDescriptorSetLayoutBinding>& vBindings = descriptorSetLayout.GetBindings();
+    const std::vector<VkDescriptorBindingFlags>& vBindingFlags = descriptorSetLayout.GetBindingFlags();
+    Key::AppendKey(m_DescriptorLayoutKey, static_cast<uint32_t>(vBindings.size()));
+    for (size_t index{}; index < vBindings.size(); ++index)
+    {
+        Key::AppendKey(m_DescriptorLayoutKey, vBindings[index].binding);
+        Key::AppendKey(m_DescriptorLayoutKey, vBindings[index].descriptorType);
+        Key::AppendKey(m_DescriptorLayoutKey, vBindings[index].descriptorCount);
+        Key::AppendKey(m_DescriptorLayoutKey, vBindings[index].stageFlags);
+        Key::AppendKey(m_DescriptorLayoutKey, vBindings[index].pImmutableSamplers != nullptr);
+        Key::AppendKey(m_DescriptorLayoutKey, index < vBindingFlags.size() ? vBindingFlags[index] : VkDescriptorBindingFlags{});
+    }
     return *this;
 }
 
 // -- Shaders --
 ashen::PipelineBuilder& ashen::PipelineBuilder::SetVertexShader(const std::string& vs)
 {
-    LoadShaderModule(vs, m_VertexShader);
+    m_VertexShader = m_pContext->GetShaderModuleCache().GetModule(vs);
 
     VkPipelineShaderStageCreateInfo shaderInfo{};
     shaderInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -209,7 +246,7 @@ ashen::PipelineBuilder& ashen::PipelineBuilder::SetVertexShader(const std::strin
 }
 ashen::PipelineBuilder& ashen::PipelineBuilder::SetFragmentShader(const std::string& fs)
 {
-    LoadShaderModule(fs, m_FragmentShader);
+    m_FragmentShader = m_pContext->GetShaderModuleCache().GetModule(fs);
 
     VkPipelineShaderStageCreateInfo shaderInfo{};
     shaderInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -223,6 +260,24 @@ ashen::PipelineBuilder& ashen::PipelineBuilder::SetFragmentShader(const std::str
     return *this;
 }
 
+ashen::PipelineBuilder& ashen::PipelineBuilder::AddSpecializationConstant(uint32_t constantID, int32_t value)
+{
+    VkSpecializationMapEntry entry{};
+    entry.constantID = constantID;
+    entry.offset = static_cast<uint32_t>(m_vSpecializationData.size() * sizeof(int32_t));
+    entry.size = sizeof(int32_t);
+
+    m_vShaderSpecializationEntries.push_back(entry);
+    m_vSpecializationData.push_back(value);
+
+    return *this;
+}
+ashen::PipelineBuilder& ashen::PipelineBuilder::AddSpecializationConstant(uint32_t constantID, float value)
+{
+    // Same size as an int, stored by its bits so every constant stays in the one data block
+    return AddSpecializationConstant(constantID, std::bit_cast<int32_t>(value));
+}
+
 // -- Vertex --
 ashen::PipelineBuilder& ashen::PipelineBuilder::SetVertexBindingDesc(const VkVertexInputBindingDescription& desc)
 {
@@ -286,6 +341,7 @@ ashen::PipelineBuilder& ashen::PipelineBuilder::AddDynamicState(VkDynamicState d
 ashen::PipelineBuilder& ashen::PipelineBuilder::SetupDynamicRendering(VkPipelineRenderingCreateInfo& dynamicRenderInfo)
 {
     m_pNext = &dynamicRenderInfo;
+    m_pRenderingInfo = &dynamicRenderInfo;
     for (uint32_t i{}; i < dynamicRenderInfo.colorAttachmentCount; ++i)
     {
         m_vColorBlendAttachmentState.push_back(
@@ -308,6 +364,12 @@ ashen::PipelineBuilder& ashen::PipelineBuilder::SetupDynamicRendering(VkPipeline
     return *this;
 }
 
+ashen::PipelineBuilder& ashen::PipelineBuilder::EnablePipelineLibrary(bool enabled)
+{
+    m_UsePipelineLibrary = enabled;
+    return *this;
+}
+
 // -- Depth testing --
 ashen::PipelineBuilder& ashen::PipelineBuilder::SetDepthTest(VkBool32 depthRead, VkBool32 depthWrite,	VkCompareOp compareOp)
 {
@@ -339,66 +401,243 @@ void ashen::PipelineBuilder::Build(Pipeline& pipeline)
     // -- Pipeline --
     m_ColorBlendCreateInfo.attachmentCount = static_cast<uint32_t>(m_vColorBlendAttachmentState.size());
     m_ColorBlendCreateInfo.pAttachments = m_vColorBlendAttachmentState.data();
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.pNext = m_pNext;
-    pipelineInfo.stageCount = static_cast<uint32_t>(m_vShaderInfo.size());
-    pipelineInfo.pStages = m_vShaderInfo.data();
-    pipelineInfo.pVertexInputState = &m_VertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &m_InputAssembly;
-    pipelineInfo.pViewportState = &m_ViewportState;
-    pipelineInfo.pRasterizationState = &m_RasterizerInfo;
-    pipelineInfo.pMultisampleState = &m_MultiSamplingInfo;
-    pipelineInfo.pDepthStencilState = &m_DepthStencilInfo;
-    pipelineInfo.pColorBlendState = &m_ColorBlendCreateInfo;
-    pipelineInfo.pDynamicState = &m_DynamicStateInfo;
-    pipelineInfo.layout = pipeline.m_Layout;
-    pipelineInfo.renderPass = nullptr;
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex = -1;
 
-    if (vkCreateGraphicsPipelines(m_pContext->GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline.m_Pipeline) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create Graphics Pipeline!");
+    // -- Specialization --
+    if (!m_vShaderSpecializationEntries.empty())
+    {
+        m_SpecializationInfo.mapEntryCount = static_cast<uint32_t>(m_vShaderSpecializationEntries.size());
+        m_SpecializationInfo.pMapEntries = m_vShaderSpecializationEntries.data();
+        m_SpecializationInfo.dataSize = m_vSpecializationData.size() * sizeof(int32_t);
+        m_SpecializationInfo.pData = m_vSpecializationData.data();
+        for (VkPipelineShaderStageCreateInfo& shaderInfo : m_vShaderInfo)
+            shaderInfo.pSpecializationInfo = &m_SpecializationInfo;
+    }
+
+    // -- Pipeline --
+    // Linked from shared parts when the device has graphics pipeline libraries, built whole otherwise
+    if (m_UsePipelineLibrary && m_pContext->SupportsPipelineLibrary())
+        pipeline.m_Pipeline = LinkPipeline(pipeline.m_Layout, vVulkanRanges, pipeline.m_vLibraries);
+    else
+    {
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = m_pNext;
+        pipelineInfo.stageCount = static_cast<uint32_t>(m_vShaderInfo.size());
+        pipelineInfo.pStages = m_vShaderInfo.data();
+        pipelineInfo.pVertexInputState = &m_VertexInputInfo;
+        pipelineInfo.pInputAssemblyState = &m_InputAssembly;
+        pipelineInfo.pViewportState = &m_ViewportState;
+        pipelineInfo.pRasterizationState = &m_RasterizerInfo;
+        pipelineInfo.pMultisampleState = &m_MultiSamplingInfo;
+        pipelineInfo.pDepthStencilState = &m_DepthStencilInfo;
+        pipelineInfo.pColorBlendState = &m_ColorBlendCreateInfo;
+        pipelineInfo.pDynamicState = &m_DynamicStateInfo;
+        pipelineInfo.layout = pipeline.m_Layout;
+        pipelineInfo.renderPass = nullptr;
+        pipelineInfo.subpass = 0;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+        pipelineInfo.basePipelineIndex = -1;
+
+        pipeline.m_Pipeline = CreateGraphicsPipeline(pipelineInfo);
+    }
 
     pipeline.m_pContext = m_pContext;
 
     m_vPushConstantRanges.clear();
     m_vDescriptorLayouts.clear();
+    m_DescriptorLayoutKey.clear();
     m_vShaderInfo.clear();
-    if (m_VertexShader != VK_NULL_HANDLE) vkDestroyShaderModule(m_pContext->GetDevice(), m_VertexShader, nullptr);
-    if (m_FragmentShader != VK_NULL_HANDLE) vkDestroyShaderModule(m_pContext->GetDevice(), m_FragmentShader, nullptr);
+    m_vShaderSpecializationEntries.clear();
+    m_vSpecializationData.clear();
+    m_VertexShader = VK_NULL_HANDLE;
+    m_FragmentShader = VK_NULL_HANDLE;
 }
 
 
 //--------------------------------------------------
 //    Helper
 //--------------------------------------------------
-void ashen::PipelineBuilder::LoadShaderModule(const std::string& filename, VkShaderModule& shaderMod) const
+VkPipeline ashen::PipelineBuilder::CreateGraphicsPipeline(VkGraphicsPipelineCreateInfo& pipelineInfo) const
 {
-    // -- Load & Read Shader --
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-    if (!file.is_open())
-        throw std::runtime_error("Failed to open file: " + filename);
-
-    size_t fileSize = (size_t)file.tellg();
-
-    std::vector<char> vCode{};
-    vCode.resize(fileSize);
-
-    file.seekg(0);
-    file.read(vCode.data(), static_cast<uint32_t>(fileSize));
+    // -- Creation Feedback --
+    // Tells whether the pipeline came out of the on-disk cache, the spec wants one entry per stage even if unused
+    VkPipelineCreationFeedback creationFeedback{};
+    std::vector<VkPipelineCreationFeedback> vStageFeedback(pipelineInfo.stageCount);
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{};
+    feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+    feedbackInfo.pNext = pipelineInfo.pNext;
+    feedbackInfo.pPipelineCreationFeedback = &creationFeedback;
+    feedbackInfo.pipelineStageCreationFeedbackCount = static_cast<uint32_t>(vStageFeedback.size());
+    feedbackInfo.pPipelineStageCreationFeedbacks = vStageFeedback.empty() ? nullptr : vStageFeedback.data();
+    pipelineInfo.pNext = &feedbackInfo;
+
+    PipelineCache& cache = m_pContext->GetPipelineCache();
+    VkPipeline vkPipeline{};
+    const auto start = std::chrono::steady_clock::now();
+    if (vkCreateGraphicsPipelines(m_pContext->GetDevice(), cache.GetHandle(), 1, &pipelineInfo, nullptr, &vkPipeline) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create Graphics Pipeline!");
+    cache.RecordFeedback(creationFeedback, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 
-    file.close();
+    return vkPipeline;
+}
+VkPipeline ashen::PipelineBuilder::LinkPipeline(VkPipelineLayout layout, const std::vector<VkPushConstantRange>& vPushConstantRanges, std::array<VkPipeline, 4>& vOutLibraries) const
+{
+    using Key = PipelineLibraryCache;
+    PipelineLibraryCache& libraries = m_pContext->GetPipelineLibraryCache();
 
-    // -- Create Shader Module --
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = vCode.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(vCode.data());
+    const VkPipelineShaderStageCreateInfo* pVertexStage{};
+    const VkPipelineShaderStageCreateInfo* pFragmentStage{};
+    for (const VkPipelineShaderStageCreateInfo& shaderInfo : m_vShaderInfo)
+    {
+        if (shaderInfo.stage == VK_SHADER_STAGE_VERTEX_BIT) pVertexStage = &shaderInfo;
+        if (shaderInfo.stage == VK_SHADER_STAGE_FRAGMENT_BIT) pFragmentStage = &shaderInfo;
+    }
 
-    if (vkCreateShaderModule(m_pContext->GetDevice(), &createInfo, nullptr, &shaderMod) != VK_SUCCESS)
-        throw std::runtime_error("Failed to create Shader Module!");
+    auto createLibrary = [this](VkGraphicsPipelineLibraryFlagsEXT part, VkGraphicsPipelineCreateInfo pipelineInfo)
+    {
+        VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+        libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+        libraryInfo.pNext = m_pNext;
+        libraryInfo.flags = part;
+
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = &libraryInfo;
+        // Retained, so the pipeline registry can link them again with link time optimization later on
+        pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+        pipelineInfo.pDynamicState = &m_DynamicStateInfo;
+        pipelineInfo.basePipelineIndex = -1;
+        return CreateGraphicsPipeline(pipelineInfo);
+    };
+
+    // -- Shared Key Parts --
+    // Linked parts need identically defined layouts, so the layout's contents are part of both shader keys
+    std::string layoutKey = m_DescriptorLayoutKey;
+    for (const VkPushConstantRange& range : vPushConstantRanges)
+        Key::AppendKey(layoutKey, range);
+    for (size_t index{}; index < m_vShaderSpecializationEntries.size(); ++index)
+    {
+        Key::AppendKey(layoutKey, m_vShaderSpecializationEntries[index].constantID);
+        Key::AppendKey(layoutKey, m_vSpecializationData[index]);
+    }
+    for (const VkDynamicState dynamicState : m_vDynamicStates)
+        Key::AppendKey(layoutKey, dynamicState);
+
+    const uint32_t viewMask = m_pRenderingInfo ? m_pRenderingInfo->viewMask : 0;
+    const VkFormat depthFormat = m_pRenderingInfo ? m_pRenderingInfo->depthAttachmentFormat : VK_FORMAT_UNDEFINED;
+    const VkFormat stencilFormat = m_pRenderingInfo ? m_pRenderingInfo->stencilAttachmentFormat : VK_FORMAT_UNDEFINED;
+
+    // -- Vertex Input --
+    std::string vertexInputKey{ "VertexInput" };
+    for (uint32_t index{}; index < m_VertexInputInfo.vertexBindingDescriptionCount; ++index)
+        Key::AppendKey(vertexInputKey, m_VertexInputInfo.pVertexBindingDescriptions[index]);
+    for (uint32_t index{}; index < m_VertexInputInfo.vertexAttributeDescriptionCount; ++index)
+        Key::AppendKey(vertexInputKey, m_VertexInputInfo.pVertexAttributeDescriptions[index]);
+    Key::AppendKey(vertexInputKey, m_InputAssembly.topology);
+    Key::AppendKey(vertexInputKey, m_InputAssembly.primitiveRestartEnable);
+
+    const VkPipeline vertexInput = libraries.GetOrCreate(vertexInputKey, [&]()
+    {
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.pVertexInputState = &m_VertexInputInfo;
+        pipelineInfo.pInputAssemblyState = &m_InputAssembly;
+        return createLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, pipelineInfo);
+    });
+
+    // -- Pre-Rasterization --
+    std::string preRasterizationKey{ "PreRasterization" };
+    Key::AppendKey(preRasterizationKey, pVertexStage ? pVertexStage->module : VK_NULL_HANDLE);
+    Key::AppendKey(preRasterizationKey, m_RasterizerInfo.polygonMode);
+    Key::AppendKey(preRasterizationKey, m_RasterizerInfo.cullMode);
+    Key::AppendKey(preRasterizationKey, m_RasterizerInfo.frontFace);
+    Key::AppendKey(preRasterizationKey, m_RasterizerInfo.lineWidth);
+    Key::AppendKey(preRasterizationKey, m_RasterizerInfo.depthClampEnable);
+    Key::AppendKey(preRasterizationKey, m_RasterizerInfo.depthBiasEnable);
+    Key::AppendKey(preRasterizationKey, m_RasterizerInfo.rasterizerDiscardEnable);
+    Key::AppendKey(preRasterizationKey, m_ViewportState.viewportCount);
+    Key::AppendKey(preRasterizationKey, m_ViewportState.scissorCount);
+    Key::AppendKey(preRasterizationKey, viewMask);
+    preRasterizationKey += layoutKey;
+
+    const VkPipeline preRasterization = libraries.GetOrCreate(preRasterizationKey, [&]()
+    {
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.stageCount = pVertexStage ? 1 : 0;
+        pipelineInfo.pStages = pVertexStage;
+        pipelineInfo.pViewportState = &m_ViewportState;
+        pipelineInfo.pRasterizationState = &m_RasterizerInfo;
+        pipelineInfo.layout = layout;
+        return createLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, pipelineInfo);
+    });
+
+    // -- Fragment Shader --
+    std::string fragmentShaderKey{ "FragmentShader" };
+    Key::AppendKey(fragmentShaderKey, pFragmentStage ? pFragmentStage->module : VK_NULL_HANDLE);
+    Key::AppendKey(fragmentShaderKey, m_DepthStencilInfo.depthTestEnable);
+    Key::AppendKey(fragmentShaderKey, m_DepthStencilInfo.depthWriteEnable);
+    Key::AppendKey(fragmentShaderKey, m_DepthStencilInfo.depthCompareOp);
+    Key::AppendKey(fragmentShaderKey, m_DepthStencilInfo.stencilTestEnable);
+    Key::AppendKey(fragmentShaderKey, m_MultiSamplingInfo.rasterizationSamples);
+    Key::AppendKey(fragmentShaderKey, m_MultiSamplingInfo.sampleShadingEnable);
+    Key::AppendKey(fragmentShaderKey, m_MultiSamplingInfo.minSampleShading);
+    Key::AppendKey(fragmentShaderKey, viewMask);
+    Key::AppendKey(fragmentShaderKey, depthFormat);
+    Key::AppendKey(fragmentShaderKey, stencilFormat);
+    fragmentShaderKey += layoutKey;
+
+    const VkPipeline fragmentShader = libraries.GetOrCreate(fragmentShaderKey, [&]()
+    {
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.stageCount = pFragmentStage ? 1 : 0;
+        pipelineInfo.pStages = pFragmentStage;
+        pipelineInfo.pDepthStencilState = &m_DepthStencilInfo;
+        pipelineInfo.pMultisampleState = &m_MultiSamplingInfo;
+        pipelineInfo.layout = layout;
+        return createLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, pipelineInfo);
+    });
+
+    // -- Fragment Output --
+    std::string fragmentOutputKey{ "FragmentOutput" };
+    for (const VkPipelineColorBlendAttachmentState& blendState : m_vColorBlendAttachmentState)
+        Key::AppendKey(fragmentOutputKey, blendState);
+    Key::AppendKey(fragmentOutputKey, m_ColorBlendCreateInfo.logicOpEnable);
+    Key::AppendKey(fragmentOutputKey, m_ColorBlendCreateInfo.logicOp);
+    Key::AppendKey(fragmentOutputKey, m_ColorBlendCreateInfo.blendConstants);
+    Key::AppendKey(fragmentOutputKey, m_MultiSamplingInfo.rasterizationSamples);
+    Key::AppendKey(fragmentOutputKey, m_MultiSamplingInfo.alphaToCoverageEnable);
+    for (uint32_t index{}; m_pRenderingInfo && index < m_pRenderingInfo->colorAttachmentCount; ++index)
+        Key::AppendKey(fragmentOutputKey, m_pRenderingInfo->pColorAttachmentFormats[index]);
+    Key::AppendKey(fragmentOutputKey, viewMask);
+    Key::AppendKey(fragmentOutputKey, depthFormat);
+    Key::AppendKey(fragmentOutputKey, stencilFormat);
+    for (const VkDynamicState dynamicState : m_vDynamicStates)
+        Key::AppendKey(fragmentOutputKey, dynamicState);
+
+    const VkPipeline fragmentOutput = libraries.GetOrCreate(fragmentOutputKey, [&]()
+    {
+        VkGraphicsPipelineCreateInfo pipelineInfo{};
+        pipelineInfo.pColorBlendState = &m_ColorBlendCreateInfo;
+        pipelineInfo.pMultisampleState = &m_MultiSamplingInfo;
+        return createLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, pipelineInfo);
+    });
+
+    // -- Link --
+    // A plain link without link time optimization, which is the cheap part that makes switching variants fast.
+    // The optimized link of the same libraries replaces it once the pipeline registry has built it in the background.
+    vOutLibraries = { vertexInput, preRasterization, fragmentShader, fragmentOutput };
+    return LinkLibraries(layout, vOutLibraries, 0);
+}
+VkPipeline ashen::PipelineBuilder::LinkLibraries(VkPipelineLayout layout, const std::array<VkPipeline, 4>& vLibraries, VkPipelineCreateFlags flags) const
+{
+    VkPipelineLibraryCreateInfoKHR linkInfo{};
+    linkInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    linkInfo.libraryCount = static_cast<uint32_t>(vLibraries.size());
+    linkInfo.pLibraries = vLibraries.data();
 
-    vCode.clear();
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &linkInfo;
+    pipelineInfo.flags = flags;
+    pipelineInfo.layout = layout;
+    pipelineInfo.basePipelineIndex = -1;
+    return CreateGraphicsPipeline(pipelineInfo);
 }
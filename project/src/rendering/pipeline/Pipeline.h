@@ -5,6 +5,8 @@
 #include <vulkan/vulkan.h>
 
 // -- Standard Library --
+#include <array>
+#include <string>
 #include <vector>
 
 // -- Ashen Includes --
@@ -41,6 +43,14 @@ namespace ashen
 		void Bind(VkCommandBuffer cmd) const;
 		void Destroy();
 
+		// -- Link Time Optimization --
+		// A pipeline fast linked from libraries can be linked again from them with link time optimization, slower to create but faster to run.
+		// Creating it only reads the pipeline, a worker can do it while frames still use the fast link.
+		bool IsFastLinked() const;
+		VkPipeline CreateOptimized() const;
+		// The fast link stays alive until Destroy, frames in flight may still use it
+		void SetOptimized(VkPipeline optimized);
+
 		//--------------------------------------------------
 		//    Accessors & Mutators
 		//--------------------------------------------------
@@ -50,9 +60,13 @@ namespace ashen
 	private:
 
 		VkPipeline m_Pipeline{};
+		VkPipeline m_FastLinkedPipeline{};
 		VkPipelineLayout m_Layout{};
 		VulkanContext* m_pContext{};
 
+		// -- Owned by the context's PipelineLibraryCache, only set when the pipeline is fast linked --
+		std::array<VkPipeline, 4> m_vLibraries{};
+
 		friend class PipelineBuilder;
 	};
 
@@ -102,11 +116,14 @@ namespace ashen
 		PushConstantRange& AddPushConstantRange();
 
 		// -- Descriptors --
-		PipelineBuilder& AddDescriptorSet(DescriptorSet& descriptorSetLayout);
+		PipelineBuilder& AddDescriptorSet(const DescriptorSet& descriptorSetLayout);
 
 		// -- Shaders --
 		PipelineBuilder& SetVertexShader(const std::string& vs);
 		PipelineBuilder& SetFragmentShader(const std::string& fs);
+		// Applied to every stage, constants a stage does not declare are ignored by it
+		PipelineBuilder& AddSpecializationConstant(uint32_t constantID, int32_t value);
+		PipelineBuilder& AddSpecializationConstant(uint32_t constantID, float value);
 
 		// -- Vertex --
 		PipelineBuilder& SetVertexBindingDesc(const VkVertexInputBindingDescription& desc);
@@ -124,6 +141,9 @@ namespace ashen
 		PipelineBuilder& AddDynamicState(VkDynamicState dynamicState);
 		PipelineBuilder& SetupDynamicRendering(VkPipelineRenderingCreateInfo& dynamicRenderInfo);
 
+		// Builds from VK_EXT_graphics_pipeline_library parts shared with other pipelines if the device supports it
+		PipelineBuilder& EnablePipelineLibrary(bool enabled);
+
 		// -- Depth Testing --
 		PipelineBuilder& SetDepthTest(VkBool32 depthRead, VkBool32 depthWrite, VkCompareOp compareOp);
 
@@ -131,8 +151,13 @@ namespace ashen
 		void Build(Pipeline& pipeline);
 
 	private:
-		void LoadShaderModule(const std::string& filename, VkShaderModule& shaderMod) const;
+		VkPipeline CreateGraphicsPipeline(VkGraphicsPipelineCreateInfo& pipelineInfo) const;
+		VkPipeline LinkPipeline(VkPipelineLayout layout, const std::vector<VkPushConstantRange>& vPushConstantRanges, std::array<VkPipeline, 4>& vOutLibraries) const;
+		VkPipeline LinkLibraries(VkPipelineLayout layout, const std::array<VkPipeline, 4>& vLibraries, VkPipelineCreateFlags flags) const;
+
 		void*		m_pNext;
+		const VkPipelineRenderingCreateInfo*				m_pRenderingInfo{};
+		bool												m_UsePipelineLibrary{};
 
 		VkPipelineVertexInputStateCreateInfo				m_VertexInputInfo{};
 		VkPipelineInputAssemblyStateCreateInfo				m_InputAssembly{};
@@ -147,13 +172,18 @@ namespace ashen
 		std::vector<VkDynamicState>							m_vDynamicStates;
 		std::vector<VkPipelineShaderStageCreateInfo>		m_vShaderInfo;
 		std::vector<VkSpecializationMapEntry >				m_vShaderSpecializationEntries;
-		std::vector<VkSpecializationInfo>					m_vSpecializationInfo;
+		std::vector<int32_t>								m_vSpecializationData;
+		VkSpecializationInfo								m_SpecializationInfo{};
 		std::vector<PushConstantRange>						m_vPushConstantRanges;
 		std::vector<VkDescriptorSetLayout>					m_vDescriptorLayouts;
+		std::string											m_DescriptorLayoutKey;
 
+		// -- Owned by the context's ShaderModuleCache --
 		VkShaderModule										m_VertexShader{};
 		VkShaderModule										m_FragmentShader{};
 		VulkanContext*										m_pContext{};
+
+		friend class Pipeline;
 	};
 
 
@@ -0,0 +1,187 @@
+// -- Standard Library --
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "PipelineCache.h"
+#include "ConsoleTextSettings.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  PipelineCache
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path)
+	: m_Device{ device }
+	, m_Path{ path }
+{
+	vkGetPhysicalDeviceProperties(physicalDevice, &m_Properties);
+
+	const std::vector<char> vData = Load();
+	m_LoadedBytes = vData.size();
+
+	VkPipelineCacheCreateInfo cacheInfo{};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize = vData.size();
+	cacheInfo.pInitialData = vData.empty() ? nullptr : vData.data();
+
+	if (vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_Cache) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create Pipeline Cache!");
+}
+ashen::PipelineCache::~PipelineCache()
+{
+	PrintReport();
+	Save();
+	vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+void ashen::PipelineCache::RecordFeedback(const VkPipelineCreationFeedback& feedback, double wallMilliseconds)
+{
+	// Drivers that do not fill in the feedback are still timed, they just can not tell hits from misses
+	if (!(feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT))
+	{
+		++m_Unreported;
+		m_UnreportedMicroseconds += static_cast<uint64_t>(wallMilliseconds * 1'000.0);
+		return;
+	}
+
+	const uint64_t microseconds = feedback.duration / 1'000;
+	if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)
+	{
+		++m_Hits;
+		m_HitMicroseconds += microseconds;
+	}
+	else
+	{
+		++m_Misses;
+		m_MissMicroseconds += microseconds;
+	}
+}
+void ashen::PipelineCache::PrintReport() const
+{
+	auto milliseconds = [](uint64_t microseconds) { return static_cast<double>(microseconds) / 1'000.0; };
+
+	std::cout << DARK_CYAN_TXT << "[PipelineCache] " << m_Hits << " hit(s) in " << milliseconds(m_HitMicroseconds) << "ms, "
+		<< m_Misses << " miss(es) in " << milliseconds(m_MissMicroseconds) << "ms";
+	if (m_Unreported > 0)
+		std::cout << ", " << m_Unreported << " without feedback in " << milliseconds(m_UnreportedMicroseconds) << "ms";
+	std::cout << " (started from " << m_LoadedBytes << " bytes)" << RESET_TXT << "\n";
+}
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+VkPipelineCache ashen::PipelineCache::GetHandle() const
+{
+	return m_Cache;
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+std::vector<char> ashen::PipelineCache::Load() const
+{
+	std::ifstream file(m_Path, std::ios::binary);
+	if (!file.is_open())
+		return {};
+
+	// -- Nothing is allocated from the file before its header is known to be ours and its size fits the file --
+	// A truncated, corrupt or foreign file starts the cache cold instead of failing the allocation
+	FileHeader header{};
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader)))
+		return {};
+
+	if (!IsCompatible(header))
+	{
+		std::cout << DARK_YELLOW_TXT << "[PipelineCache] " << m_Path << " was written by another device or driver, starting empty" << RESET_TXT << "\n";
+		return {};
+	}
+
+	std::error_code error{};
+	const uintmax_t fileSize = std::filesystem::file_size(m_Path, error);
+	if (error || fileSize < sizeof(FileHeader) || header.dataSize == 0 || header.dataSize > fileSize - sizeof(FileHeader))
+		return {};
+
+	std::vector<char> vData(static_cast<size_t>(header.dataSize));
+	if (!file.read(vData.data(), static_cast<std::streamsize>(vData.size())))
+		return {};
+
+	if (!IsDriverCompatible(vData))
+	{
+		std::cout << DARK_YELLOW_TXT << "[PipelineCache] " << m_Path << " holds data of another device or driver, starting empty" << RESET_TXT << "\n";
+		return {};
+	}
+	return vData;
+}
+bool ashen::PipelineCache::IsCompatible(const FileHeader& header) const
+{
+	if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+		return false;
+	if (header.vendorID != m_Properties.vendorID || header.deviceID != m_Properties.deviceID || header.driverVersion != m_Properties.driverVersion)
+		return false;
+	return std::memcmp(header.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+bool ashen::PipelineCache::IsDriverCompatible(const std::vector<char>& vData) const
+{
+	// -- A corrupt blob is allowed to crash some drivers instead of being rejected --
+	VkPipelineCacheHeaderVersionOne driverHeader{};
+	if (vData.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+		return false;
+	std::memcpy(&driverHeader, vData.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+
+	return driverHeader.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne)
+		&& driverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& driverHeader.vendorID == m_Properties.vendorID
+		&& driverHeader.deviceID == m_Properties.deviceID
+		&& std::memcmp(driverHeader.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+void ashen::PipelineCache::Save() const
+{
+	size_t size{};
+	if (vkGetPipelineCacheData(m_Device, m_Cache, &size, nullptr) != VK_SUCCESS || size == 0)
+		return;
+
+	std::vector<char> vData(size);
+	if (vkGetPipelineCacheData(m_Device, m_Cache, &size, vData.data()) != VK_SUCCESS)
+		return;
+
+	FileHeader header
+	{
+		.magic = FILE_MAGIC,
+		.version = FILE_VERSION,
+		.vendorID = m_Properties.vendorID,
+		.deviceID = m_Properties.deviceID,
+		.driverVersion = m_Properties.driverVersion,
+		.pipelineCacheUUID = {},
+		.dataSize = size
+	};
+	std::memcpy(header.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+	// Written next to the old file first, a crash halfway never leaves a truncated cache behind
+	const std::string tempPath = m_Path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+		file.write(vData.data(), static_cast<std::streamsize>(size));
+		if (!file)
+			return;
+	}
+
+	std::error_code error{};
+	std::filesystem::rename(tempPath, m_Path, error);
+	if (error)
+		std::cout << DARK_YELLOW_TXT << "[PipelineCache] Failed to write " << m_Path << ": " << error.message() << RESET_TXT << "\n";
+}
@@ -0,0 +1,82 @@
+#ifndef ASHEN_PIPELINE_CACHE_H
+#define ASHEN_PIPELINE_CACHE_H
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Standard Library --
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  PipelineCache
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// VkPipelineCache that is loaded from disk on creation and written back on destruction.
+	// The file is only trusted if it was written by the same device & driver, anything else starts from an empty cache.
+	// Creation feedback of every pipeline built through it is collected, so the effect of the cache can be reported.
+	class PipelineCache final
+	{
+	public:
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path);
+		~PipelineCache();
+
+		PipelineCache(const PipelineCache& other) = delete;
+		PipelineCache(PipelineCache&& other) noexcept = delete;
+		PipelineCache& operator=(const PipelineCache& other) = delete;
+		PipelineCache& operator=(PipelineCache&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Safe to call from any thread, pipelines are built on background threads
+		void RecordFeedback(const VkPipelineCreationFeedback& feedback, double wallMilliseconds);
+		void PrintReport() const;
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		VkPipelineCache GetHandle() const;
+
+	private:
+		// -- Written in front of the driver's blob, the driver's own header has no driver version --
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+			uint64_t dataSize;
+		};
+		static constexpr uint32_t FILE_MAGIC = 0x43505341;     // "ASPC"
+		static constexpr uint32_t FILE_VERSION = 1;
+
+		VkDevice m_Device{};
+		VkPipelineCache m_Cache{ VK_NULL_HANDLE };
+		VkPhysicalDeviceProperties m_Properties{};
+		std::string m_Path{};
+		size_t m_LoadedBytes{};
+
+		// -- Feedback --
+		std::atomic<uint32_t> m_Hits{};
+		std::atomic<uint32_t> m_Misses{};
+		std::atomic<uint32_t> m_Unreported{};
+		std::atomic<uint64_t> m_HitMicroseconds{};
+		std::atomic<uint64_t> m_MissMicroseconds{};
+		std::atomic<uint64_t> m_UnreportedMicroseconds{};
+
+		std::vector<char> Load() const;
+		bool IsCompatible(const FileHeader& header) const;
+		bool IsDriverCompatible(const std::vector<char>& vData) const;
+		void Save() const;
+	};
+}
+
+#endif // ASHEN_PIPELINE_CACHE_H
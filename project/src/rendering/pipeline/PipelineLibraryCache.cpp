@@ -0,0 +1,58 @@
+// -- Ashen Includes --
+#include "PipelineLibraryCache.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  PipelineLibraryCache
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::PipelineLibraryCache::PipelineLibraryCache(VkDevice device)
+	: m_Device{ device }
+{}
+ashen::PipelineLibraryCache::~PipelineLibraryCache()
+{
+	// Parts whose creation threw never produced a handle
+	for (auto& library : m_Libraries)
+	{
+		try
+		{
+			vkDestroyPipeline(m_Device, library.second.get(), nullptr);
+		}
+		catch (...) {}
+	}
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+VkPipeline ashen::PipelineLibraryCache::GetOrCreate(const std::string& key, const CreateFunc& create)
+{
+	std::promise<VkPipeline> promise{};
+	{
+		std::unique_lock lock{ m_Mutex };
+		const auto it = m_Libraries.find(key);
+		if (it != m_Libraries.end())
+		{
+			const std::shared_future<VkPipeline> library = it->second;
+			lock.unlock();
+			return library.get();
+		}
+		m_Libraries.emplace(key, promise.get_future().share());
+	}
+
+	// -- Created outside of the lock, other parts can be compiled at the same time --
+	try
+	{
+		const VkPipeline library = create();
+		promise.set_value(library);
+		return library;
+	}
+	catch (...)
+	{
+		promise.set_exception(std::current_exception());
+		throw;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef ASHEN_PIPELINE_LIBRARY_CACHE_H
+#define ASHEN_PIPELINE_LIBRARY_CACHE_H
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Standard Library --
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  PipelineLibraryCache
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Graphics pipeline library parts (VK_EXT_graphics_pipeline_library), keyed by the state that went into them.
+	// Pipelines that only differ in e.g. their color format or cull mode share every other part and only pay for a link.
+	// Parts live as long as the device, pipelines linked from them stay valid until they are destroyed themselves.
+	class PipelineLibraryCache final
+	{
+	public:
+		using CreateFunc = std::function<VkPipeline()>;
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit PipelineLibraryCache(VkDevice device);
+		~PipelineLibraryCache();
+
+		PipelineLibraryCache(const PipelineLibraryCache& other) = delete;
+		PipelineLibraryCache(PipelineLibraryCache&& other) noexcept = delete;
+		PipelineLibraryCache& operator=(const PipelineLibraryCache& other) = delete;
+		PipelineLibraryCache& operator=(PipelineLibraryCache&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Safe to call from any thread, a part that is being created by another thread is waited on instead of created twice
+		VkPipeline GetOrCreate(const std::string& key, const CreateFunc& create);
+
+		// Keys are the raw bytes of the state, only append values without padding or pointers
+		template<typename T>
+		static void AppendKey(std::string& key, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+	private:
+		VkDevice m_Device{};
+		std::mutex m_Mutex{};
+		std::unordered_map<std::string, std::shared_future<VkPipeline>> m_Libraries{};
+	};
+}
+
+#endif // ASHEN_PIPELINE_LIBRARY_CACHE_H
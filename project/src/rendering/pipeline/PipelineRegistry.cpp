@@ -0,0 +1,122 @@
+// -- Standard Library --
+#include <chrono>
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "PipelineRegistry.h"
+#include "ThreadPool.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  PipelineRegistry
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::PipelineRegistry::PipelineRegistry(ThreadPool& threadPool)
+	: m_pThreadPool{ &threadPool }
+{}
+ashen::PipelineRegistry::~PipelineRegistry()
+{
+	// Workers may still be writing into the pipelines, they have to finish before the pipelines are destroyed
+	for (auto& entry : m_Entries)
+	{
+		if (entry.second.pending.valid())
+			entry.second.pending.wait();
+
+		// Optimized links that were never swapped in are handed to their pipeline, so it destroys them
+		if (entry.second.optimizing.valid())
+		{
+			try
+			{
+				entry.second.pPipeline->SetOptimized(entry.second.optimizing.get());
+			}
+			catch (...) {}
+		}
+	}
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+void ashen::PipelineRegistry::Register(const std::string& name, VkFormat format, BuildFunc build)
+{
+	const auto [it, inserted] = m_Entries.try_emplace({ name, format });
+	if (!inserted)
+		return;
+
+	Entry& entry = it->second;
+	entry.pPipeline = std::make_unique<Pipeline>();
+	entry.pending = m_pThreadPool->Submit([pPipeline = entry.pPipeline.get(), build = std::move(build)](uint32_t)
+	{
+		build(*pPipeline);
+	});
+}
+const ashen::Pipeline& ashen::PipelineRegistry::Get(const std::string& name, VkFormat format)
+{
+	const auto it = m_Entries.find({ name, format });
+	if (it == m_Entries.end())
+		throw std::runtime_error("Pipeline was never registered: " + name);
+
+	// Rethrows whatever the build threw
+	Entry& entry = it->second;
+	if (entry.pending.valid())
+		entry.pending.get();
+	return *entry.pPipeline;
+}
+const ashen::Pipeline* ashen::PipelineRegistry::TryGet(const std::string& name, VkFormat format)
+{
+	const auto it = m_Entries.find({ name, format });
+	if (it == m_Entries.end())
+		return nullptr;
+
+	Entry& entry = it->second;
+	if (entry.pending.valid())
+	{
+		if (entry.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return nullptr;
+		entry.pending.get();
+	}
+	return entry.pPipeline.get();
+}
+bool ashen::PipelineRegistry::IsReady(VkFormat format)
+{
+	for (const auto& it : m_Entries)
+	{
+		if (it.first.second == format && !TryGet(it.first.first, format))
+			return false;
+	}
+	return true;
+}
+void ashen::PipelineRegistry::Update()
+{
+	for (auto& it : m_Entries)
+	{
+		Entry& entry = it.second;
+
+		// -- Optimized link finished, frames recorded from now on use it --
+		// Rethrows whatever the link threw
+		if (entry.optimizing.valid())
+		{
+			if (entry.optimizing.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+				entry.pPipeline->SetOptimized(entry.optimizing.get());
+			continue;
+		}
+
+		// -- Fast link finished, the optimized one is queued behind every build that is still waiting --
+		// A build that threw left the pipeline empty, it is not fast linked and Get rethrows instead
+		if (entry.optimizeQueued)
+			continue;
+		if (entry.pending.valid() && entry.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			continue;
+		if (!entry.pPipeline->IsFastLinked())
+			continue;
+
+		entry.optimizeQueued = true;
+		entry.optimizing = m_pThreadPool->Submit([pPipeline = entry.pPipeline.get()](uint32_t)
+		{
+			return pPipeline->CreateOptimized();
+		});
+	}
+}
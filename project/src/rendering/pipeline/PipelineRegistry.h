@@ -0,0 +1,82 @@
+#ifndef ASHEN_PIPELINE_REGISTRY_H
+#define ASHEN_PIPELINE_REGISTRY_H
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Standard Library --
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+// -- Ashen Includes --
+#include "Pipeline.h"
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class ThreadPool;
+}
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  PipelineRegistry
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Pipelines keyed by name & color attachment format, every variant is built up front on the pool's workers.
+	// Switching between variants is a lookup, nothing is rebuilt and the device never has to go idle for it.
+	// Pipelines fast linked from graphics pipeline libraries are linked again with link time optimization on the workers,
+	// Update swaps that link in once it is done, so references handed out before keep pointing at the current pipeline.
+	// The registry itself is not thread safe, register and get from the thread that owns the renderer.
+	class PipelineRegistry final
+	{
+	public:
+		using BuildFunc = std::function<void(Pipeline&)>;
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit PipelineRegistry(ThreadPool& threadPool);
+		~PipelineRegistry();
+
+		PipelineRegistry(const PipelineRegistry& other) = delete;
+		PipelineRegistry(PipelineRegistry&& other) noexcept = delete;
+		PipelineRegistry& operator=(const PipelineRegistry& other) = delete;
+		PipelineRegistry& operator=(PipelineRegistry&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Starts building in the background, variants that were registered before are left as they are.
+		// The build function runs on a worker, it should only use its own builder and read-only renderer state.
+		void Register(const std::string& name, VkFormat format, BuildFunc build);
+
+		// Waits for the build if it is still running, the reference stays valid for the lifetime of the registry
+		const Pipeline& Get(const std::string& name, VkFormat format);
+		// Never waits, returns nullptr while the build is still running or if the variant was never registered
+		const Pipeline* TryGet(const std::string& name, VkFormat format);
+		// Never waits, whether every variant registered for the format has finished building
+		bool IsReady(VkFormat format);
+
+		// Call once per frame, swaps in finished optimized links & queues those of fast links that finished since the last call
+		void Update();
+
+	private:
+		struct Entry
+		{
+			std::unique_ptr<Pipeline> pPipeline;
+			std::future<void> pending;
+			std::future<VkPipeline> optimizing;
+			bool optimizeQueued{};
+		};
+		using Key = std::pair<std::string, VkFormat>;
+
+		ThreadPool* m_pThreadPool{};
+		std::map<Key, Entry> m_Entries{};
+	};
+}
+
+#endif // ASHEN_PIPELINE_REGISTRY_H
@@ -0,0 +1,94 @@
+// -- Standard Library --
+#include <algorithm>
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "ShaderModuleCache.h"
+#include "MappedFile.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  ShaderModuleCache
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::ShaderModuleCache::ShaderModuleCache(VkDevice device)
+	: m_Device{ device }
+{}
+ashen::ShaderModuleCache::~ShaderModuleCache()
+{
+	for (const auto& modules : m_Modules)
+	{
+		for (const ModuleEntry& module : modules.second)
+			vkDestroyShaderModule(m_Device, module.module, nullptr);
+	}
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+VkShaderModule ashen::ShaderModuleCache::GetModule(const std::string& path)
+{
+	std::error_code timeError{};
+	std::error_code sizeError{};
+	const auto writeTime = std::filesystem::last_write_time(path, timeError);
+	const auto size = std::filesystem::file_size(path, sizeError);
+	if (timeError || sizeError)
+		throw std::runtime_error("Failed to open file: " + path);
+
+	std::lock_guard lock{ m_Mutex };
+
+	// -- Unchanged File --
+	const auto fileIt = m_Files.find(path);
+	if (fileIt != m_Files.end() && fileIt->second.writeTime == writeTime && fileIt->second.size == size)
+		return fileIt->second.module;
+
+	// -- New or Changed File --
+	const MappedFile file{ path };
+	if (file.GetSize() % sizeof(uint32_t) != 0)
+		throw std::runtime_error("SPIR-V size is not a multiple of 4: " + path);
+
+	// -- Identical Contents --
+	const std::byte* pCode = file.GetData();
+	const uint64_t hash = HashContents(pCode, file.GetSize());
+	std::vector<ModuleEntry>& vCandidates = m_Modules[hash];
+	for (const ModuleEntry& candidate : vCandidates)
+	{
+		if (std::equal(candidate.vCode.begin(), candidate.vCode.end(), pCode, pCode + file.GetSize()))
+		{
+			m_Files[path] = FileEntry{ writeTime, size, candidate.module };
+			return candidate.module;
+		}
+	}
+
+	VkShaderModuleCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = file.GetSize();
+	createInfo.pCode = reinterpret_cast<const uint32_t*>(file.GetData());
+
+	VkShaderModule shaderModule{};
+	if (vkCreateShaderModule(m_Device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create Shader Module!");
+
+	vCandidates.push_back(ModuleEntry{ std::vector<std::byte>(pCode, pCode + file.GetSize()), shaderModule });
+	m_Files[path] = FileEntry{ writeTime, size, shaderModule };
+	return shaderModule;
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+uint64_t ashen::ShaderModuleCache::HashContents(const std::byte* pData, size_t size)
+{
+	// -- FNV-1a --
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t index{}; index < size; ++index)
+	{
+		hash ^= static_cast<uint64_t>(pData[index]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
@@ -0,0 +1,66 @@
+#ifndef ASHEN_SHADER_MODULE_CACHE_H
+#define ASHEN_SHADER_MODULE_CACHE_H
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Standard Library --
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  ShaderModuleCache
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Shader modules that stay alive for the lifetime of the device, so rebuilding a pipeline does not touch the disk again.
+	// Files are only re-read once their size or write time changes, and identical SPIR-V shares one module.
+	// The hash only finds candidates, contents are compared byte for byte before a module is shared.
+	// Modules are owned by the cache, pipelines must not destroy them.
+	class ShaderModuleCache final
+	{
+	public:
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit ShaderModuleCache(VkDevice device);
+		~ShaderModuleCache();
+
+		ShaderModuleCache(const ShaderModuleCache& other) = delete;
+		ShaderModuleCache(ShaderModuleCache&& other) noexcept = delete;
+		ShaderModuleCache& operator=(const ShaderModuleCache& other) = delete;
+		ShaderModuleCache& operator=(ShaderModuleCache&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Safe to call from any thread, pipelines are built on background threads
+		VkShaderModule GetModule(const std::string& path);
+
+	private:
+		struct FileEntry
+		{
+			std::filesystem::file_time_type writeTime;
+			uintmax_t size;
+			VkShaderModule module;
+		};
+		struct ModuleEntry
+		{
+			std::vector<std::byte> vCode;
+			VkShaderModule module;
+		};
+
+		static uint64_t HashContents(const std::byte* pData, size_t size);
+
+		VkDevice m_Device{};
+		std::mutex m_Mutex{};
+		std::unordered_map<std::string, FileEntry> m_Files{};
+		std::unordered_map<uint64_t, std::vector<ModuleEntry>> m_Modules{};     // Keyed by the hash of the contents, colliding contents share a key
+	};
+}
+
+#endif // ASHEN_SHADER_MODULE_CACHE_H
@@ -0,0 +1,266 @@
+// -- Standard Library --
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+// -- Ashen Includes --
+#include "GpuProfiler.h"
+#include "VulkanContext.h"
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::GpuProfiler::GpuProfiler(VulkanContext& context, uint32_t framesInFlight, uint32_t historySize)
+	: m_pContext{ &context }
+	, m_FramesInFlight{ framesInFlight }
+	, m_HistorySize{ std::max(historySize, 1u) }
+{
+	// -- Timestamp Support --
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(m_pContext->GetPhysicalDevice(), &properties);
+
+	uint32_t familyCount{};
+	vkGetPhysicalDeviceQueueFamilyProperties(m_pContext->GetPhysicalDevice(), &familyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> vFamilies(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(m_pContext->GetPhysicalDevice(), &familyCount, vFamilies.data());
+
+	const uint32_t validBits = vFamilies[m_pContext->GetQueueIndex(vkb::QueueType::graphics)].timestampValidBits;
+	m_Supported = validBits != 0;
+	m_TimestampPeriod = properties.limits.timestampPeriod;
+	m_TimestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t{ 1 } << validBits) - 1;
+
+	m_vFrameIndices.assign(m_FramesInFlight, INVALID_FRAME);
+
+	// -- Timestamp Pool --
+	// Both pools are optional on their own, a queue without timestamps can still count pipeline statistics
+	if (m_Supported)
+	{
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = m_FramesInFlight * MAX_SCOPES * 2;
+
+		if (vkCreateQueryPool(m_pContext->GetDevice(), &poolInfo, nullptr, &m_QueryPool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create Timestamp Query Pool!");
+	}
+
+	// -- Statistics Pool --
+	if (!m_pContext->GetEnabledFeatures().pipelineStatisticsQuery)
+		return;
+
+	VkQueryPoolCreateInfo statisticsInfo{};
+	statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	statisticsInfo.queryCount = m_FramesInFlight * MAX_SCOPES;
+	statisticsInfo.pipelineStatistics =
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+	if (vkCreateQueryPool(m_pContext->GetDevice(), &statisticsInfo, nullptr, &m_StatisticsPool) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create Pipeline Statistics Query Pool!");
+}
+ashen::GpuProfiler::~GpuProfiler()
+{
+	if (m_QueryPool != VK_NULL_HANDLE)
+		vkDestroyQueryPool(m_pContext->GetDevice(), m_QueryPool, nullptr);
+	if (m_StatisticsPool != VK_NULL_HANDLE)
+		vkDestroyQueryPool(m_pContext->GetDevice(), m_StatisticsPool, nullptr);
+}
+
+
+//--------------------------------------------------
+//    Scopes
+//--------------------------------------------------
+uint32_t ashen::GpuProfiler::RegisterScope(const std::string& name, bool collectStatistics)
+{
+	if (m_vScopeNames.size() >= MAX_SCOPES)
+		throw std::runtime_error("Too many GPU Profiler Scopes!");
+
+	m_vScopeNames.push_back(name);
+	m_vHistory.emplace_back();
+	m_vLastMs.push_back(0.0);
+	m_vCollectStatistics.push_back(collectStatistics);
+	m_vLastStatistics.push_back({});
+	return static_cast<uint32_t>(m_vScopeNames.size() - 1);
+}
+const std::vector<std::string>& ashen::GpuProfiler::GetScopeNames() const
+{
+	return m_vScopeNames;
+}
+
+
+//--------------------------------------------------
+//    Commands
+//--------------------------------------------------
+void ashen::GpuProfiler::BeginFrame(VkCommandBuffer cmd, uint32_t frame, uint64_t frameIndex)
+{
+	m_CurrentFrame = frame;
+	if (!m_Supported && m_StatisticsPool == VK_NULL_HANDLE)
+		return;
+
+	// Resets have to happen outside of a rendering instance, so the whole range of this frame is reset up front
+	if (m_Supported)
+		vkCmdResetQueryPool(cmd, m_QueryPool, QueryIndex(frame, 0), MAX_SCOPES * 2);
+	if (m_StatisticsPool != VK_NULL_HANDLE)
+		vkCmdResetQueryPool(cmd, m_StatisticsPool, StatisticsIndex(frame, 0), MAX_SCOPES);
+	m_vFrameIndices[frame] = frameIndex;
+}
+void ashen::GpuProfiler::BeginScope(VkCommandBuffer cmd, uint32_t scope) const
+{
+	if (m_Supported)
+		vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_QueryPool, QueryIndex(m_CurrentFrame, scope));
+	if (m_StatisticsPool != VK_NULL_HANDLE && m_vCollectStatistics[scope])
+		vkCmdBeginQuery(cmd, m_StatisticsPool, StatisticsIndex(m_CurrentFrame, scope), 0);
+}
+void ashen::GpuProfiler::EndScope(VkCommandBuffer cmd, uint32_t scope) const
+{
+	if (m_StatisticsPool != VK_NULL_HANDLE && m_vCollectStatistics[scope])
+		vkCmdEndQuery(cmd, m_StatisticsPool, StatisticsIndex(m_CurrentFrame, scope));
+	if (m_Supported)
+		vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_QueryPool, QueryIndex(m_CurrentFrame, scope) + 1);
+}
+
+
+//--------------------------------------------------
+//    Results
+//--------------------------------------------------
+void ashen::GpuProfiler::Resolve(uint32_t frame)
+{
+	// Only call this once the fence of the frame has been waited on
+	if (m_vFrameIndices[frame] == INVALID_FRAME)
+		return;
+
+	// Scopes that were skipped this frame stay unavailable, the availability word tells them apart without waiting
+	struct QueryResult
+	{
+		uint64_t value;
+		uint64_t available;
+	};
+	const uint32_t scopeCount = static_cast<uint32_t>(m_vScopeNames.size());
+	std::vector<QueryResult> vResults(static_cast<size_t>(scopeCount) * 2);
+	if (m_Supported && scopeCount > 0)
+	{
+		const VkResult result = vkGetQueryPoolResults(m_pContext->GetDevice(), m_QueryPool, QueryIndex(frame, 0), scopeCount * 2,
+			vResults.size() * sizeof(QueryResult), vResults.data(), sizeof(QueryResult),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (result != VK_SUCCESS && result != VK_NOT_READY)
+			throw std::runtime_error("Failed to read Timestamp Queries!");
+	}
+
+	std::lock_guard lock{ m_ResultsMutex };
+	ResolveStatistics(frame);
+	const uint64_t frameIndex = m_vFrameIndices[frame];
+	m_vFrameIndices[frame] = INVALID_FRAME;
+	if (!m_Supported)
+		return;
+
+	GpuFrameTiming timing{ .frame = frameIndex, .vScopeMilliseconds = std::vector<double>(scopeCount) };
+	for (uint32_t scope{}; scope < scopeCount; ++scope)
+	{
+		const QueryResult& begin = vResults[scope * 2];
+		const QueryResult& end = vResults[scope * 2 + 1];
+		if (!begin.available || !end.available)
+		{
+			timing.vScopeMilliseconds[scope] = std::numeric_limits<double>::quiet_NaN();
+			continue;
+		}
+
+		const uint64_t ticks = (end.value - begin.value) & m_TimestampMask;
+		const double ms = static_cast<double>(ticks) * m_TimestampPeriod / 1'000'000.0;
+		timing.vScopeMilliseconds[scope] = ms;
+
+		m_vLastMs[scope] = ms;
+		m_vHistory[scope].push_back(ms);
+		if (m_vHistory[scope].size() > m_HistorySize)
+			m_vHistory[scope].pop_front();
+	}
+
+	m_PendingTimings.push_back(std::move(timing));
+	if (m_PendingTimings.size() > MAX_PENDING_TIMINGS)
+		m_PendingTimings.pop_front();
+}
+bool ashen::GpuProfiler::IsSupported() const
+{
+	return m_Supported;
+}
+bool ashen::GpuProfiler::IsStatisticsSupported() const
+{
+	return m_StatisticsPool != VK_NULL_HANDLE;
+}
+std::vector<ashen::GpuProfiler::ScopeStats> ashen::GpuProfiler::GetStats() const
+{
+	std::lock_guard lock{ m_ResultsMutex };
+	std::vector<ScopeStats> vStats{};
+	vStats.reserve(m_vScopeNames.size());
+	for (size_t scope{}; scope < m_vScopeNames.size(); ++scope)
+	{
+		ScopeStats stats
+		{
+			.name = m_vScopeNames[scope],
+			.lastMs = m_vLastMs[scope], .minMs = 0.0, .avgMs = 0.0, .maxMs = 0.0,
+			.hasStatistics = IsStatisticsSupported() && m_vCollectStatistics[scope],
+			.statistics = m_vLastStatistics[scope]
+		};
+		const auto& history = m_vHistory[scope];
+		if (!history.empty())
+		{
+			const auto [minIt, maxIt] = std::minmax_element(history.begin(), history.end());
+			double sum{};
+			for (double ms : history)
+				sum += ms;
+
+			stats.minMs = *minIt;
+			stats.maxMs = *maxIt;
+			stats.avgMs = sum / static_cast<double>(history.size());
+		}
+		vStats.push_back(stats);
+	}
+	return vStats;
+}
+std::vector<ashen::GpuFrameTiming> ashen::GpuProfiler::ConsumeTimings()
+{
+	std::lock_guard lock{ m_ResultsMutex };
+	std::vector<GpuFrameTiming> vTimings{ m_PendingTimings.begin(), m_PendingTimings.end() };
+	m_PendingTimings.clear();
+	return vTimings;
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+uint32_t ashen::GpuProfiler::QueryIndex(uint32_t frame, uint32_t scope) const
+{
+	return (frame * MAX_SCOPES + scope) * 2;
+}
+uint32_t ashen::GpuProfiler::StatisticsIndex(uint32_t frame, uint32_t scope) const
+{
+	return frame * MAX_SCOPES + scope;
+}
+void ashen::GpuProfiler::ResolveStatistics(uint32_t frame)
+{
+	if (m_StatisticsPool == VK_NULL_HANDLE || m_vScopeNames.empty())
+		return;
+
+	struct StatisticsResult
+	{
+		PipelineStatistics statistics;
+		uint64_t available;
+	};
+	const uint32_t scopeCount = static_cast<uint32_t>(m_vScopeNames.size());
+	std::vector<StatisticsResult> vResults(scopeCount);
+	const VkResult result = vkGetQueryPoolResults(m_pContext->GetDevice(), m_StatisticsPool, StatisticsIndex(frame, 0), scopeCount,
+		vResults.size() * sizeof(StatisticsResult), vResults.data(), sizeof(StatisticsResult),
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+		throw std::runtime_error("Failed to read Pipeline Statistics Queries!");
+
+	for (uint32_t scope{}; scope < scopeCount; ++scope)
+	{
+		if (m_vCollectStatistics[scope] && vResults[scope].available)
+			m_vLastStatistics[scope] = vResults[scope].statistics;
+	}
+}
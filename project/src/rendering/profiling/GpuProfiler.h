@@ -0,0 +1,128 @@
+#ifndef ASHEN_GPU_PROFILER_H
+#define ASHEN_GPU_PROFILER_H
+
+// -- Standard Library --
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// -- Vulkan Includes --
+#include <vulkan/vulkan.h>
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class VulkanContext;
+}
+
+namespace ashen
+{
+	// -- Pipeline statistics of a scope, in the order Vulkan writes them for the requested flags --
+	// Clipping primitives is what survives frustum clipping, back-face culling happens after it and is not counted
+	struct PipelineStatistics
+	{
+		uint64_t inputAssemblyPrimitives;
+		uint64_t vertexShaderInvocations;
+		uint64_t clippingInvocations;
+		uint64_t clippingPrimitives;
+		uint64_t fragmentShaderInvocations;
+	};
+
+	// -- GPU durations of every scope of a completed frame, NaN for scopes that were not recorded that frame --
+	struct GpuFrameTiming
+	{
+		uint64_t frame;
+		std::vector<double> vScopeMilliseconds;
+	};
+
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  GpuProfiler
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Timestamp profiler with one query range per frame in flight.
+	// Results are read back when the frame's slot comes around again, its fence has signaled by then so reading never stalls.
+	// The results may be read from another thread than the one recording and resolving.
+	class GpuProfiler final
+	{
+	public:
+		struct ScopeStats
+		{
+			std::string name;
+			double lastMs;
+			double minMs;
+			double avgMs;
+			double maxMs;
+
+			bool hasStatistics;
+			PipelineStatistics statistics;              // Of the last resolved frame
+		};
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit GpuProfiler(VulkanContext& context, uint32_t framesInFlight, uint32_t historySize = 120);
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler& other) = delete;
+		GpuProfiler(GpuProfiler&& other) noexcept = delete;
+		GpuProfiler& operator=(const GpuProfiler& other) = delete;
+		GpuProfiler& operator=(GpuProfiler&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Scopes
+		//--------------------------------------------------
+		// Statistics queries of one pool can not be nested, only leaf scopes (the passes) should collect them
+		uint32_t RegisterScope(const std::string& name, bool collectStatistics = false);
+		const std::vector<std::string>& GetScopeNames() const;
+
+		//--------------------------------------------------
+		//    Commands
+		//--------------------------------------------------
+		void BeginFrame(VkCommandBuffer cmd, uint32_t frame, uint64_t frameIndex);
+		void BeginScope(VkCommandBuffer cmd, uint32_t scope) const;
+		void EndScope(VkCommandBuffer cmd, uint32_t scope) const;
+
+		//--------------------------------------------------
+		//    Results
+		//--------------------------------------------------
+		void Resolve(uint32_t frame);
+		bool IsSupported() const;
+		bool IsStatisticsSupported() const;
+		std::vector<ScopeStats> GetStats() const;
+		std::vector<GpuFrameTiming> ConsumeTimings();
+
+	private:
+		static constexpr uint32_t MAX_SCOPES = 16;
+		static constexpr uint64_t INVALID_FRAME = UINT64_MAX;
+		static constexpr size_t MAX_PENDING_TIMINGS = 1024;
+
+		VulkanContext* m_pContext{};
+		VkQueryPool m_QueryPool{ VK_NULL_HANDLE };
+		VkQueryPool m_StatisticsPool{ VK_NULL_HANDLE };
+
+		bool m_Supported{};
+		float m_TimestampPeriod{};
+		uint64_t m_TimestampMask{};
+
+		uint32_t m_FramesInFlight{};
+		uint32_t m_HistorySize{};
+		uint32_t m_CurrentFrame{};
+
+		std::vector<std::string> m_vScopeNames{};
+
+		// -- Results, guarded by the mutex --
+		mutable std::mutex m_ResultsMutex{};
+		std::vector<std::deque<double>> m_vHistory{};
+		std::vector<double> m_vLastMs{};
+		std::vector<bool> m_vCollectStatistics{};
+		std::vector<PipelineStatistics> m_vLastStatistics{};
+		std::vector<uint64_t> m_vFrameIndices{};
+		std::deque<GpuFrameTiming> m_PendingTimings{};
+
+		uint32_t QueryIndex(uint32_t frame, uint32_t scope) const;
+		uint32_t StatisticsIndex(uint32_t frame, uint32_t scope) const;
+		void ResolveStatistics(uint32_t frame);
+	};
+}
+
+#endif // ASHEN_GPU_PROFILER_H
@@ -0,0 +1,339 @@
+// -- Standard Library --
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// -- Math Includes --
+#include <glm/gtc/constants.hpp>
+
+// -- Ashen Includes --
+#include "DomeLod.h"
+#include "VulkanContext.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  DomeLod
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Constructor & Destructor
+//--------------------------------------------------
+ashen::DomeLod::DomeLod(VulkanContext& context, const DomeLodSettings& settings)
+	: m_Settings{ settings }
+{
+	const uint32_t gridSize = m_Settings.gridSize;
+	const uint32_t verticesPerSide = gridSize + 1;
+	if (gridSize < 2 || gridSize % 2 != 0 || verticesPerSide * verticesPerSide > 65536)
+		throw std::runtime_error("Dome LOD grid size has to be even & fit 16 bit indices!");
+	if (m_Settings.maxLevel > 16)
+		throw std::runtime_error("Dome LOD max level can not be above 16!");
+
+	// -- Indices, same grid & winding as Renderer::CreateDome, rows along theta --
+	std::vector<uint32_t> vIndices{};
+	vIndices.reserve(static_cast<size_t>(gridSize) * gridSize * 6);
+	for (uint32_t row{}; row < gridSize; ++row)
+	{
+		for (uint32_t column{}; column < gridSize; ++column)
+		{
+			const uint32_t current = row * verticesPerSide + column;
+			const uint32_t next = current + verticesPerSide;
+
+			vIndices.insert(vIndices.end(), { current, current + 1, next });
+			vIndices.insert(vIndices.end(), { next, current + 1, next + 1 });
+		}
+	}
+
+	// -- Only the triangles are reordered, the vertex shader finds a vertex's place in the grid from its index --
+	const uint32_t vertexCount = verticesPerSide * verticesPerSide;
+	m_CacheStatsBefore = MeshOptimizer::AnalyzeVertexCache(vIndices, vertexCount);
+	MeshOptimizer::OptimizeVertexCache(vIndices, vertexCount);
+	m_CacheStatsAfter = MeshOptimizer::AnalyzeVertexCache(vIndices, vertexCount);
+
+	std::vector<uint16_t> vIndices16(vIndices.size());
+	for (size_t index{}; index < vIndices.size(); ++index)
+		vIndices16[index] = static_cast<uint16_t>(vIndices[index]);
+
+	m_IndexCount = static_cast<uint32_t>(vIndices16.size());
+	const uint32_t iBufferSize = static_cast<uint32_t>(sizeof(uint16_t)) * m_IndexCount;
+	BufferAllocator bufferAlloc{ context };
+	bufferAlloc
+		.SetSize(iBufferSize)
+		.HostAccess(false)
+		.SetMemoryTag(MemoryTag::Mesh)
+		.SetUsage(VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+		.AddInitialData(vIndices16.data(), 0, iBufferSize)
+		.Allocate(m_IndexBuffer);
+}
+
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+void ashen::DomeLod::Select(const View& view, float radius, float pixelError, bool cullBehindHorizon, std::vector<Patch>& vOutPatches)
+{
+	m_FrustumPlanes = GetFrustumPlanes(view.viewProj);
+	m_Leaves.clear();
+	m_vPending.clear();
+	for (uint32_t root{}; root < 4; ++root)
+		m_vPending.push_back({ .level = 0, .x = root & 1, .y = root >> 1 });
+
+	// -- Refine, patches that are not seen are never split --
+	// Breadth first, so a dome that runs into the patch budget is left evenly coarse instead of detailed on one side only
+	for (size_t next{}; next < m_vPending.size(); ++next)
+	{
+		const Node node = m_vPending[next];
+		const size_t unvisited = m_vPending.size() - next - 1;
+
+		const Bounds bounds = GetBounds(node);
+		const bool split = node.level < m_Settings.maxLevel
+			&& m_Leaves.size() + unvisited + 4 <= m_Settings.maxPatches
+			&& IsVisible(view, radius, cullBehindHorizon, bounds)
+			&& GetScreenError(view, radius, node, bounds) > pixelError;
+		if (!split)
+		{
+			m_Leaves.insert(GetKey(node));
+			continue;
+		}
+
+		for (uint32_t child{}; child < 4; ++child)
+			m_vPending.push_back({ .level = node.level + 1, .x = node.x * 2 + (child & 1), .y = node.y * 2 + (child >> 1) });
+	}
+
+	// -- Balance, a patch may border patches one level coarser at most, so only every other vertex of an edge has to snap --
+	// Splitting a neighbour can unbalance its own neighbours, repeat until a pass splits nothing
+	bool balanced = false;
+	while (!balanced)
+	{
+		balanced = true;
+		m_vBalance.assign(m_Leaves.begin(), m_Leaves.end());
+		for (const uint64_t key : m_vBalance)
+		{
+			if (!m_Leaves.contains(key))
+				continue;
+
+			const Node node = GetNode(key);
+			for (uint32_t edge{}; edge < 4; ++edge)
+			{
+				const std::optional<Node> neighbour = FindNeighbour(node, edge);
+				if (neighbour && neighbour->level + 1 < node.level)
+				{
+					Split(*neighbour);
+					balanced = false;
+				}
+			}
+		}
+	}
+
+	// -- Visible leaves, with the edges they share with a coarser patch --
+	// Balancing after the budget ran out can in theory go past the capacity, the rest is dropped rather than overflow the instance buffer
+	vOutPatches.clear();
+	for (const uint64_t key : m_Leaves)
+	{
+		if (vOutPatches.size() >= GetPatchCapacity())
+			break;
+
+		const Node node = GetNode(key);
+		if (!IsVisible(view, radius, cullBehindHorizon, GetBounds(node)))
+			continue;
+
+		uint32_t coarserEdges{};
+		for (uint32_t edge{}; edge < 4; ++edge)
+		{
+			const std::optional<Node> neighbour = FindNeighbour(node, edge);
+			if (neighbour && neighbour->level < node.level)
+				coarserEdges |= 1u << edge;
+		}
+
+		const float size = GetNodeSize(node.level);
+		vOutPatches.push_back(
+			{
+				.theta = static_cast<float>(node.y) * size,
+				.phi = static_cast<float>(node.x) * size,
+				.size = size,
+				.coarserEdges = static_cast<float>(coarserEdges)
+			});
+	}
+}
+void ashen::DomeLod::Draw(VkCommandBuffer cmd, VkBuffer patchBuffer, VkDeviceSize patchOffset, uint32_t patchCount) const
+{
+	if (patchCount == 0)
+		return;
+
+	vkCmdBindVertexBuffers(cmd, 0, 1, &patchBuffer, &patchOffset);
+	vkCmdBindIndexBuffer(cmd, m_IndexBuffer.GetHandle(), 0, VK_INDEX_TYPE_UINT16);
+	vkCmdDrawIndexed(cmd, m_IndexCount, patchCount, 0, 0, 0);
+}
+
+
+//--------------------------------------------------
+//    Accessors & Mutators
+//--------------------------------------------------
+uint32_t ashen::DomeLod::GetGridSize() const { return m_Settings.gridSize; }
+uint32_t ashen::DomeLod::GetVerticesPerPatch() const { return (m_Settings.gridSize + 1) * (m_Settings.gridSize + 1); }
+uint32_t ashen::DomeLod::GetPatchCapacity() const { return 2 * m_Settings.maxPatches; }
+const ashen::MeshOptimizer::CacheStats& ashen::DomeLod::GetCacheStatsBefore() const { return m_CacheStatsBefore; }
+const ashen::MeshOptimizer::CacheStats& ashen::DomeLod::GetCacheStatsAfter() const { return m_CacheStatsAfter; }
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+bool ashen::DomeLod::IsVisible(const View& view, float radius, bool cullBehindHorizon, const Bounds& bounds) const
+{
+	// -- Frustum, a patch is outside a plane once all its samples are further outside than the rest of the patch can reach --
+	// Between samples the distance to the plane changes at most as fast as the plane's normal runs along the patch,
+	// a sphere around the whole patch would keep every patch below a camera close to the ground
+	for (const glm::vec4& plane : m_FrustumPlanes)
+	{
+		const glm::vec3 normal{ plane };
+		const float normalDot = glm::dot(normal, bounds.center);
+		const float tangent = std::sqrt(std::max(0.f, 1.f - normalDot * normalDot));
+		const float margin = radius * bounds.step * std::min(1.f, tangent + bounds.angle);
+		const bool outside = std::all_of(bounds.vSamples.begin(), bounds.vSamples.end(), [&](const glm::vec3& sample)
+		{
+			return glm::dot(normal, sample * radius) + plane.w < -margin;
+		});
+		if (outside)
+			return false;
+	}
+
+	// -- Horizon, a patch that lies entirely further from the camera than the horizon is hidden by the planet in front of it --
+	// The dome is only the upper hemisphere, that only holds while the camera is above it, so the line of sight can not pass below
+	if (cullBehindHorizon)
+	{
+		const float height = glm::length(view.cameraPos);
+		if (height > radius && view.cameraPos.y >= 0.f)
+		{
+			const float horizonAngle = std::acos(radius / height);
+			const float patchAngle = std::acos(std::clamp(glm::dot(bounds.center, view.cameraPos / height), -1.f, 1.f));
+			if (patchAngle - bounds.angle > horizonAngle)
+				return false;
+		}
+	}
+	return true;
+}
+float ashen::DomeLod::GetScreenError(const View& view, float radius, const Node& node, const Bounds& bounds) const
+{
+	// -- Projected length of one grid cell, at the nearest the patch can get to the camera --
+	float nearest = std::numeric_limits<float>::max();
+	for (const glm::vec3& sample : bounds.vSamples)
+		nearest = std::min(nearest, glm::length(sample * radius - view.cameraPos));
+	const float distance = std::max(nearest - bounds.step * radius, radius * MIN_DISTANCE);
+	const float cellLength = radius * GetNodeSize(node.level) / static_cast<float>(m_Settings.gridSize);
+	return cellLength / distance * view.pixelsPerRadian;
+}
+void ashen::DomeLod::Split(const Node& node)
+{
+	m_Leaves.erase(GetKey(node));
+	for (uint32_t child{}; child < 4; ++child)
+		m_Leaves.insert(GetKey({ .level = node.level + 1, .x = node.x * 2 + (child & 1), .y = node.y * 2 + (child >> 1) }));
+}
+std::optional<ashen::DomeLod::Node> ashen::DomeLod::FindNeighbour(const Node& node, uint32_t edge) const
+{
+	// -- A point just across the middle of the edge, in cells of the deepest level --
+	const uint32_t maxLevel = m_Settings.maxLevel;
+	const uint32_t span = 1u << (maxLevel - node.level);
+	const uint32_t cells = 2u << maxLevel;
+	const uint32_t x = node.x * span;
+	const uint32_t y = node.y * span;
+
+	// -- The first & last rows end in a pole, the first & last columns on the horizon, there is nothing across either --
+	uint32_t probeX = x + span / 2;
+	uint32_t probeY = y + span / 2;
+	switch (edge)
+	{
+	case 0:
+		if (y == 0)
+			return {};
+		probeY = y - 1;
+		break;
+	case 1:
+		if (y + span >= cells)
+			return {};
+		probeY = y + span;
+		break;
+	case 2:
+		if (x == 0)
+			return {};
+		probeX = x - 1;
+		break;
+	default:
+		if (x + span >= cells)
+			return {};
+		probeX = x + span;
+		break;
+	}
+
+	// -- The leaf containing it, coarsest first --
+	for (uint32_t level{}; level <= maxLevel; ++level)
+	{
+		const Node candidate{ .level = level, .x = probeX >> (maxLevel - level), .y = probeY >> (maxLevel - level) };
+		if (m_Leaves.contains(GetKey(candidate)))
+			return candidate;
+	}
+	return {};
+}
+
+float ashen::DomeLod::GetNodeSize(uint32_t level)
+{
+	return glm::half_pi<float>() / static_cast<float>(1u << level);
+}
+ashen::DomeLod::Bounds ashen::DomeLod::GetBounds(const Node& node)
+{
+	const float size = GetNodeSize(node.level);
+	const float theta = static_cast<float>(node.y) * size;
+	const float phi = static_cast<float>(node.x) * size;
+	const float step = size / static_cast<float>(BOUNDS_SAMPLES - 1);
+
+	Bounds bounds{};
+	bounds.center = GetDirection(theta + size * 0.5f, phi + size * 0.5f);
+
+	// -- The largest angle to the center is on the edges, the angle along an edge only grows towards its ends --
+	for (uint32_t row{}; row < BOUNDS_SAMPLES; ++row)
+	{
+		for (uint32_t column{}; column < BOUNDS_SAMPLES; ++column)
+		{
+			const glm::vec3 sample = GetDirection(theta + step * static_cast<float>(row), phi + step * static_cast<float>(column));
+			bounds.vSamples[row * BOUNDS_SAMPLES + column] = sample;
+			bounds.angle = std::max(bounds.angle, std::acos(std::clamp(glm::dot(sample, bounds.center), -1.f, 1.f)));
+		}
+	}
+
+	// -- Half a step in theta & at most half a step in phi, which only shrinks towards the poles, reach the nearest sample --
+	bounds.step = step;
+	return bounds;
+}
+glm::vec3 ashen::DomeLod::GetDirection(float theta, float phi)
+{
+	return { std::cos(theta), std::sin(phi) * std::sin(theta), std::cos(phi) * std::sin(theta) };
+}
+uint64_t ashen::DomeLod::GetKey(const Node& node)
+{
+	return (static_cast<uint64_t>(node.level) << 48) | (static_cast<uint64_t>(node.x) << 24) | static_cast<uint64_t>(node.y);
+}
+ashen::DomeLod::Node ashen::DomeLod::GetNode(uint64_t key)
+{
+	constexpr uint64_t MASK = (1ull << 24) - 1;
+	return { .level = static_cast<uint32_t>(key >> 48), .x = static_cast<uint32_t>((key >> 24) & MASK), .y = static_cast<uint32_t>(key & MASK) };
+}
+std::array<glm::vec4, 6> ashen::DomeLod::GetFrustumPlanes(const glm::mat4& viewProj)
+{
+	// -- Rows of the matrix, GLM stores columns --
+	glm::vec4 rows[4]{};
+	for (int row{}; row < 4; ++row)
+		rows[row] = { viewProj[0][row], viewProj[1][row], viewProj[2][row], viewProj[3][row] };
+
+	// -- Clip space is x & y in -w - w and z in 0 - w, the planes point inwards --
+	std::array<glm::vec4, 6> planes
+	{
+		rows[3] + rows[0],
+		rows[3] - rows[0],
+		rows[3] + rows[1],
+		rows[3] - rows[1],
+		rows[2],
+		rows[3] - rows[2]
+	};
+	for (glm::vec4& plane : planes)
+		plane /= glm::length(glm::vec3(plane));
+	return planes;
+}
@@ -0,0 +1,141 @@
+#ifndef ASHEN_DOME_LOD_H
+#define ASHEN_DOME_LOD_H
+
+// -- Standard Library --
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+// -- Math Includes --
+#include <glm/glm.hpp>
+
+// -- Ashen Includes --
+#include "Buffer.h"
+#include "MeshOptimizer.h"
+
+// -- Forward Declarations --
+namespace ashen
+{
+	class VulkanContext;
+}
+
+namespace ashen
+{
+	struct DomeLodSettings
+	{
+		uint32_t gridSize{ 16 };        // Cells along each side of a patch, every patch draws the same grid
+		uint32_t maxLevel{ 8 };         // Deepest split, a patch there spans 90 degrees / 2^maxLevel
+		uint32_t maxPatches{ 2048 };    // Splitting stops once a dome has this many patches, balancing may still add some
+	};
+
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  DomeLod
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Camera dependent level of detail for the domes, a quadtree over their latitude & longitude around the horizontal x axis.
+	// Around the vertical axis all patches would meet in the zenith, right above the camera, its poles lie on the dome's rim instead.
+	// Four roots of 90 by 90 degrees cover the hemisphere, a split halves a patch in both.
+	// Patches are split until a cell of their grid covers at most the allowed number of pixels, patches outside the frustum
+	// or behind the planet's horizon are never split and never drawn, so the scattering runs for the vertices that are seen.
+	//
+	// Neighbours differ by at most one level, a patch next to a coarser one snaps the odd vertices of that edge onto the coarse edge,
+	// so levels meet without cracks. All patches are instances of one grid, the vertex shader places them from the instance data.
+	class DomeLod final
+	{
+	public:
+		// -- Per instance data, read as the vec4 vertex input of VERTEX_LAYOUT 4 in Helper_Vertex.glsl --
+		struct Patch
+		{
+			float theta{};          // Angle of the first row from +x, 0 - 180 degrees
+			float phi{};            // Angle of the first column from +z around x, 0 - 180 degrees towards +y
+			float size{};           // Extent in both latitude & longitude, in radians
+			float coarserEdges{};   // Edges next to a coarser patch, bit 0 first row, 1 last row, 2 first column, 3 last column
+		};
+		struct View
+		{
+			glm::vec3 cameraPos{};
+			glm::mat4 viewProj{};
+			float pixelsPerRadian{};    // Viewport height / (2 tan(fov / 2)), what a unit at a distance of one covers on screen
+		};
+
+		//--------------------------------------------------
+		//    Constructor & Destructor
+		//--------------------------------------------------
+		explicit DomeLod(VulkanContext& context, const DomeLodSettings& settings = {});
+		~DomeLod() = default;
+
+		DomeLod(const DomeLod& other) = delete;
+		DomeLod(DomeLod&& other) noexcept = delete;
+		DomeLod& operator=(const DomeLod& other) = delete;
+		DomeLod& operator=(DomeLod&& other) noexcept = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Picks the patches of a unit dome drawn at the given radius, overwrites vOutPatches with the visible ones.
+		// Only the planet itself hides anything behind its horizon, pass cullBehindHorizon for the ground alone.
+		// Reuses scratch memory of the last call, only call it from one thread.
+		void Select(const View& view, float radius, float pixelError, bool cullBehindHorizon, std::vector<Patch>& vOutPatches);
+
+		// Draws the patches read from the instance buffer, the pipeline's push constants have to be set already
+		void Draw(VkCommandBuffer cmd, VkBuffer patchBuffer, VkDeviceSize patchOffset, uint32_t patchCount) const;
+
+		//--------------------------------------------------
+		//    Accessors & Mutators
+		//--------------------------------------------------
+		uint32_t GetGridSize() const;
+		uint32_t GetVerticesPerPatch() const;
+		uint32_t GetPatchCapacity() const;     // Most patches Select ever returns
+		const MeshOptimizer::CacheStats& GetCacheStatsBefore() const;
+		const MeshOptimizer::CacheStats& GetCacheStatsAfter() const;
+
+	private:
+		// -- Patches closer than this, relative to the radius, are as detailed as they get --
+		static constexpr float MIN_DISTANCE = 1e-4f;
+
+		struct Node
+		{
+			uint32_t level{};
+			uint32_t x{};           // Along phi, 0 - 2 * 2^level
+			uint32_t y{};           // Along theta, 0 - 2 * 2^level
+		};
+		// -- A grid of points on the patch, any other point of it is within one step from one of them --
+		static constexpr uint32_t BOUNDS_SAMPLES = 5;
+		struct Bounds
+		{
+			glm::vec3 center{};     // Direction through the middle of the patch
+			float angle{};          // Largest angle between the center & the patch's edges
+			std::array<glm::vec3, BOUNDS_SAMPLES * BOUNDS_SAMPLES> vSamples{};  // Unit directions
+			float step{};           // Angle between neighbouring samples
+		};
+
+		DomeLodSettings m_Settings{};
+
+		Buffer m_IndexBuffer{};
+		uint32_t m_IndexCount{};
+		MeshOptimizer::CacheStats m_CacheStatsBefore{};
+		MeshOptimizer::CacheStats m_CacheStatsAfter{};
+
+		// -- Scratch of Select --
+		std::unordered_set<uint64_t> m_Leaves{};
+		std::vector<Node> m_vPending{};
+		std::vector<uint64_t> m_vBalance{};
+		std::array<glm::vec4, 6> m_FrustumPlanes{};
+
+		// -- Helpers --
+		bool IsVisible(const View& view, float radius, bool cullBehindHorizon, const Bounds& bounds) const;
+		float GetScreenError(const View& view, float radius, const Node& node, const Bounds& bounds) const;
+		void Split(const Node& node);
+		std::optional<Node> FindNeighbour(const Node& node, uint32_t edge) const;
+
+		static float GetNodeSize(uint32_t level);
+		static Bounds GetBounds(const Node& node);
+		static glm::vec3 GetDirection(float theta, float phi);
+		static uint64_t GetKey(const Node& node);
+		static Node GetNode(uint64_t key);
+		static std::array<glm::vec4, 6> GetFrustumPlanes(const glm::mat4& viewProj);
+	};
+}
+
+#endif // ASHEN_DOME_LOD_H
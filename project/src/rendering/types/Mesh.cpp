@@ -1,32 +1,96 @@
-﻿// -- Ashen Includes --
+﻿// -- Standard Library --
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// -- Ashen Includes --
 #include "Mesh.h"
 
 
 //--------------------------------------------------
 //    Constructor & Destructor
 //--------------------------------------------------
-ashen::Mesh::Mesh(VulkanContext& context, const std::vector<Vertex>& v, const std::vector<uint32_t>& i)
+ashen::Mesh::Mesh(VulkanContext& context, const std::vector<Vertex>& v, const std::vector<uint32_t>& i, const MeshSettings& settings)
 	: m_vVertices(v)
 	, m_vIndices(i)
+	, m_VertexLayout(settings.layout)
+	, m_VertexCount(static_cast<uint32_t>(v.size()))
+	, m_IndexCount(static_cast<uint32_t>(i.size()))
 	, m_pContext(&context)
 {
-    uint32_t vBufferSize = sizeof(m_vVertices[0]) * static_cast<uint32_t>(m_vVertices.size());
+    if (m_VertexLayout == VertexLayout::Procedural || m_VertexLayout == VertexLayout::Patches)
+        throw std::runtime_error("A mesh can not use the procedural or patch vertex layout, it has no vertex buffer!");
+    if (m_IndexCount % 3 != 0)
+        throw std::runtime_error("A mesh is a triangle list, its index count has to be a multiple of 3!");
+
+    // -- Vertex Cache --
+    // The triangles are reordered to reuse recently shaded vertices, then the vertices are renumbered in the order they are first used
+    m_CacheStatsBefore = MeshOptimizer::AnalyzeVertexCache(m_vIndices, m_VertexCount);
+    if (settings.optimize)
+    {
+        MeshOptimizer::OptimizeVertexCache(m_vIndices, m_VertexCount);
+        const std::vector<uint32_t> vRemap = MeshOptimizer::OptimizeVertexFetch(m_vIndices, m_VertexCount);
+
+        std::vector<Vertex> vRemapped(m_vVertices.size());
+        for (size_t vertex{}; vertex < m_vVertices.size(); ++vertex)
+            vRemapped[vRemap[vertex]] = m_vVertices[vertex];
+        m_vVertices = std::move(vRemapped);
+    }
+    m_CacheStatsAfter = MeshOptimizer::AnalyzeVertexCache(m_vIndices, m_VertexCount);
+
+    // -- The quantized layouts store positions relative to the furthest vertex --
+    if (m_VertexLayout != VertexLayout::Position)
+    {
+        m_PositionScale = 0.f;
+        for (const Vertex& vertex : m_vVertices)
+            m_PositionScale = std::max(m_PositionScale, glm::length(vertex.pos));
+        if (m_PositionScale <= 0.f)
+            m_PositionScale = 1.f;
+    }
+
+    std::vector<std::byte> vPacked = PackVertices();
+    uint32_t vBufferSize = static_cast<uint32_t>(vPacked.size());
 	BufferAllocator bufferAlloc{ context };
     bufferAlloc
         .SetSize(vBufferSize)
         .HostAccess(false)
+        .SetMemoryTag(MemoryTag::Mesh)
         .SetUsage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
-        .AddInitialData(m_vVertices.data(), 0, vBufferSize)
+        .AddInitialData(vPacked.data(), 0, vBufferSize)
 		.Allocate(m_VertexBuffer);
 
-    uint32_t iBufferSize = sizeof(m_vIndices[0]) * static_cast<uint32_t>(m_vIndices.size());
+    // -- 16 bit indices halve the index buffer, meshes that would need too many draws for it keep 32 bit --
+    std::vector<uint16_t> vIndices16{};
+    if (settings.allowIndices16)
+    {
+        m_vIndexChunks = MeshOptimizer::SplitIndices16(m_vIndices, vIndices16);
+        if (m_vIndexChunks.size() > MAX_INDEX_CHUNKS)
+            m_vIndexChunks.clear();
+    }
+    if (m_vIndexChunks.empty())
+        m_vIndexChunks.push_back({ .firstIndex = 0, .indexCount = m_IndexCount, .vertexOffset = 0 });
+    else
+        m_IndexType = VK_INDEX_TYPE_UINT16;
+
+    // -- Sized from the indices that are uploaded, not the count the mesh was created with --
+    const bool indices16 = m_IndexType == VK_INDEX_TYPE_UINT16;
+    uint32_t iBufferSize = static_cast<uint32_t>(indices16 ? sizeof(uint16_t) * vIndices16.size() : sizeof(uint32_t) * m_vIndices.size());
     bufferAlloc = { context };
     bufferAlloc
         .SetSize(iBufferSize)
         .HostAccess(false)
+        .SetMemoryTag(MemoryTag::Mesh)
         .SetUsage(VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
-        .AddInitialData((void*)m_vIndices.data(), 0, iBufferSize)
+        .AddInitialData(indices16 ? static_cast<void*>(vIndices16.data()) : static_cast<void*>(m_vIndices.data()), 0, iBufferSize)
 		.Allocate(m_IndexBuffer);
+
+    // -- Initial data is copied out during the upload, nothing reads the CPU copies after this --
+    if (!settings.keepCpuData)
+    {
+        m_vVertices = {};
+        m_vIndices = {};
+    }
 }
 ashen::Mesh::~Mesh()
 { }
@@ -39,14 +103,74 @@ void ashen::Mesh::Bind(VkCommandBuffer cmd) const
 {
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(cmd, 0, 1, &m_VertexBuffer.GetHandle(), offsets);
-    vkCmdBindIndexBuffer(cmd, m_IndexBuffer.GetHandle(), 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(cmd, m_IndexBuffer.GetHandle(), 0, m_IndexType);
 }
 void ashen::Mesh::Draw(VkCommandBuffer cmd) const
 {
-    vkCmdDrawIndexed(cmd, static_cast<uint32_t>(m_vIndices.size()), 1, 0, 0, 0);
+    for (const MeshOptimizer::IndexChunk& chunk : m_vIndexChunks)
+        vkCmdDrawIndexed(cmd, chunk.indexCount, 1, chunk.firstIndex, chunk.vertexOffset, 0);
 }
 
 
 //--------------------------------------------------
 //    Accessors & Mutators
 //--------------------------------------------------
+ashen::VertexLayout ashen::Mesh::GetVertexLayout() const { return m_VertexLayout; }
+float ashen::Mesh::GetPositionScale() const { return m_PositionScale; }
+uint32_t ashen::Mesh::GetVertexCount() const { return m_VertexCount; }
+uint32_t ashen::Mesh::GetIndexCount() const { return m_IndexCount; }
+VkIndexType ashen::Mesh::GetIndexType() const { return m_IndexType; }
+uint32_t ashen::Mesh::GetIndexChunkCount() const { return static_cast<uint32_t>(m_vIndexChunks.size()); }
+const ashen::MeshOptimizer::CacheStats& ashen::Mesh::GetCacheStatsBefore() const { return m_CacheStatsBefore; }
+const ashen::MeshOptimizer::CacheStats& ashen::Mesh::GetCacheStatsAfter() const { return m_CacheStatsAfter; }
+const std::vector<ashen::Vertex>& ashen::Mesh::GetVertices() const { return m_vVertices; }
+const std::vector<uint32_t>& ashen::Mesh::GetIndices() const { return m_vIndices; }
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+std::vector<std::byte> ashen::Mesh::PackVertices() const
+{
+    const uint32_t stride = Vertex::GetStride(m_VertexLayout);
+    std::vector<std::byte> vPacked(static_cast<size_t>(stride) * m_vVertices.size());
+
+    auto toSnorm = [](float value)
+    {
+        return static_cast<int16_t>(std::round(std::clamp(value, -1.f, 1.f) * 32767.f));
+    };
+
+    for (size_t index{}; index < m_vVertices.size(); ++index)
+    {
+        std::byte* pDst = vPacked.data() + index * stride;
+        const glm::vec3& pos = m_vVertices[index].pos;
+        switch (m_VertexLayout)
+        {
+        case VertexLayout::UnitSphere16:
+        {
+            const glm::vec3 unit = pos / m_PositionScale;
+            const int16_t packed[4] = { toSnorm(unit.x), toSnorm(unit.y), toSnorm(unit.z), 0 };
+            std::memcpy(pDst, packed, sizeof(packed));
+            break;
+        }
+        case VertexLayout::Octahedral16:
+        {
+            // Project the direction onto the octahedron |x| + |y| + |z| = 1 and fold the lower half over the diagonals
+            const glm::vec3 dir = pos / (std::abs(pos.x) + std::abs(pos.y) + std::abs(pos.z) + 1e-20f);
+            glm::vec2 oct{ dir.x, dir.y };
+            if (dir.z < 0.f)
+            {
+                const glm::vec2 signs{ dir.x >= 0.f ? 1.f : -1.f, dir.y >= 0.f ? 1.f : -1.f };
+                oct = (1.f - glm::abs(glm::vec2{ dir.y, dir.x })) * signs;
+            }
+            const int16_t packed[2] = { toSnorm(oct.x), toSnorm(oct.y) };
+            std::memcpy(pDst, packed, sizeof(packed));
+            break;
+        }
+        default:
+            std::memcpy(pDst, &pos, sizeof(pos));
+            break;
+        }
+    }
+    return vPacked;
+}
@@ -2,15 +2,25 @@
 #define ASHEN_MESH_H
 
 // -- Standard Library --
+#include <cstddef>
 #include <vector>
 
 // -- Ashen Includes --
 #include "Buffer.h"
+#include "MeshOptimizer.h"
 #include "Vertex.h"
 #include "VulkanContext.h"
 
 namespace ashen
 {
+    struct MeshSettings
+    {
+        VertexLayout layout{ VertexLayout::Position };
+        bool keepCpuData{ true };       // Without it the vertices & indices are dropped once uploaded, only the GPU buffers stay resident
+        bool optimize{ true };          // Reorder the triangles for the post-transform cache & the vertices for fetch locality
+        bool allowIndices16{ true };    // Split into 16 bit index chunks, as long as a few of them are enough
+    };
+
     //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     //? ~~    Mesh
     //? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -20,7 +30,7 @@ namespace ashen
         //--------------------------------------------------
         //    Constructor & Destructor
         //--------------------------------------------------
-        explicit Mesh(VulkanContext& context, const std::vector<Vertex>& v, const std::vector<uint32_t>& i);
+        explicit Mesh(VulkanContext& context, const std::vector<Vertex>& v, const std::vector<uint32_t>& i, const MeshSettings& settings = {});
         ~Mesh();
 
         Mesh(const Mesh& other) = delete;
@@ -37,6 +47,20 @@ namespace ashen
         //--------------------------------------------------
         //    Accessors & Mutators
         //--------------------------------------------------
+        VertexLayout GetVertexLayout() const;
+        float GetPositionScale() const;         // What the quantized positions are multiplied by in the vertex shader, 1 for float positions
+        uint32_t GetVertexCount() const;
+        uint32_t GetIndexCount() const;
+        VkIndexType GetIndexType() const;
+        uint32_t GetIndexChunkCount() const;
+
+        // Simulated post-transform cache misses of the triangle order as given & as uploaded
+        const MeshOptimizer::CacheStats& GetCacheStatsBefore() const;
+        const MeshOptimizer::CacheStats& GetCacheStatsAfter() const;
+
+        // Empty if the CPU copies were released after upload, in the optimized order otherwise
+        const std::vector<Vertex>& GetVertices() const;
+        const std::vector<uint32_t>& GetIndices() const;
 
     private:
         Buffer m_VertexBuffer{};
@@ -45,7 +69,23 @@ namespace ashen
         std::vector<Vertex> m_vVertices{};
         std::vector<uint32_t> m_vIndices{};
 
+        VertexLayout m_VertexLayout{ VertexLayout::Position };
+        float m_PositionScale{ 1.f };
+        uint32_t m_VertexCount{};
+        uint32_t m_IndexCount{};
+
+        // -- Index Chunks --
+        // With 16 bit indices every chunk is drawn with its own vertex offset, a single chunk covers all indices otherwise
+        static constexpr uint32_t MAX_INDEX_CHUNKS = 16;
+        VkIndexType m_IndexType{ VK_INDEX_TYPE_UINT32 };
+        std::vector<MeshOptimizer::IndexChunk> m_vIndexChunks{};
+
+        MeshOptimizer::CacheStats m_CacheStatsBefore{};
+        MeshOptimizer::CacheStats m_CacheStatsAfter{};
+
         VulkanContext* m_pContext;
+
+        std::vector<std::byte> PackVertices() const;
     };
 }
 
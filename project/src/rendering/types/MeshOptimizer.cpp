@@ -0,0 +1,276 @@
+// -- Standard Library --
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// -- Ashen Includes --
+#include "MeshOptimizer.h"
+
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//? ~~	  MeshOptimizer
+//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//--------------------------------------------------
+//    Functionality
+//--------------------------------------------------
+void ashen::MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& vIndices, uint32_t vertexCount)
+{
+	const uint32_t triangleCount = static_cast<uint32_t>(vIndices.size() / 3);
+	if (triangleCount == 0)
+		return;
+
+	// -- Adjacency, the triangles of every vertex, the ones not emitted yet are kept at the front of its range --
+	std::vector<uint32_t> vLiveTriangles(vertexCount);
+	for (const uint32_t index : vIndices)
+		++vLiveTriangles[index];
+
+	std::vector<uint32_t> vAdjacencyOffsets(vertexCount + 1);
+	for (uint32_t vertex{}; vertex < vertexCount; ++vertex)
+		vAdjacencyOffsets[vertex + 1] = vAdjacencyOffsets[vertex] + vLiveTriangles[vertex];
+
+	std::vector<uint32_t> vAdjacency(vIndices.size());
+	std::vector<uint32_t> vFill(vAdjacencyOffsets.begin(), vAdjacencyOffsets.end() - 1);
+	for (uint32_t triangle{}; triangle < triangleCount; ++triangle)
+	{
+		for (uint32_t corner{}; corner < 3; ++corner)
+			vAdjacency[vFill[vIndices[triangle * 3 + corner]]++] = triangle;
+	}
+
+	// -- Scores, nothing is cached yet so only the valence counts --
+	const ScoreTables& scoreTables = GetScoreTables();
+	std::vector<int32_t> vCachePosition(vertexCount, -1);
+	std::vector<float> vVertexScore(vertexCount);
+	for (uint32_t vertex{}; vertex < vertexCount; ++vertex)
+		vVertexScore[vertex] = GetVertexScore(scoreTables, -1, vLiveTriangles[vertex]);
+
+	auto getTriangleScore = [&vIndices, &vVertexScore](uint32_t triangle)
+	{
+		return vVertexScore[vIndices[triangle * 3]] + vVertexScore[vIndices[triangle * 3 + 1]] + vVertexScore[vIndices[triangle * 3 + 2]];
+	};
+
+	constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+	uint32_t bestTriangle{};
+	float bestScore = getTriangleScore(0);
+	for (uint32_t triangle{ 1 }; triangle < triangleCount; ++triangle)
+	{
+		const float score = getTriangleScore(triangle);
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTriangle = triangle;
+		}
+	}
+
+	// -- Emit --
+	std::vector<uint32_t> vOutput{};
+	vOutput.reserve(vIndices.size());
+	std::vector<uint8_t> vEmitted(triangleCount);
+	std::vector<uint32_t> vCache{};
+	std::vector<uint32_t> vNewCache{};
+	vCache.reserve(CACHE_SIZE + 3);
+	vNewCache.reserve(CACHE_SIZE + 3);
+	uint32_t deadEndCursor{};
+
+	for (uint32_t emitted{}; emitted < triangleCount; ++emitted)
+	{
+		// Nothing in the cache leads anywhere, restart from the first triangle that is left
+		if (bestTriangle == NO_TRIANGLE)
+		{
+			while (vEmitted[deadEndCursor])
+				++deadEndCursor;
+			bestTriangle = deadEndCursor;
+		}
+
+		const uint32_t triangleVertices[3] = { vIndices[bestTriangle * 3], vIndices[bestTriangle * 3 + 1], vIndices[bestTriangle * 3 + 2] };
+		vOutput.insert(vOutput.end(), std::begin(triangleVertices), std::end(triangleVertices));
+		vEmitted[bestTriangle] = 1;
+
+		// -- The triangle is done, swap it out of the live range of its vertices --
+		vNewCache.clear();
+		for (const uint32_t vertex : triangleVertices)
+		{
+			uint32_t* pBegin = vAdjacency.data() + vAdjacencyOffsets[vertex];
+			uint32_t* pEnd = pBegin + vLiveTriangles[vertex];
+			uint32_t* pFound = std::find(pBegin, pEnd, bestTriangle);
+			if (pFound != pEnd)
+			{
+				*pFound = *(pEnd - 1);
+				--vLiveTriangles[vertex];
+			}
+
+			// Degenerate triangles name a vertex twice, it only takes one cache entry
+			if (std::find(vNewCache.begin(), vNewCache.end(), vertex) == vNewCache.end())
+				vNewCache.push_back(vertex);
+		}
+
+		// -- The triangle's vertices move to the front of the cache, the rest shifts back --
+		for (const uint32_t vertex : vCache)
+		{
+			if (std::find(vNewCache.begin(), vNewCache.end(), vertex) == vNewCache.end())
+				vNewCache.push_back(vertex);
+		}
+		for (uint32_t position{}; position < vNewCache.size(); ++position)
+		{
+			const uint32_t vertex = vNewCache[position];
+			vCachePosition[vertex] = position < CACHE_SIZE ? static_cast<int32_t>(position) : -1;
+			vVertexScore[vertex] = GetVertexScore(scoreTables, vCachePosition[vertex], vLiveTriangles[vertex]);
+		}
+
+		// -- Only triangles of vertices that moved changed score, the best of them is next --
+		bestTriangle = NO_TRIANGLE;
+		bestScore = std::numeric_limits<float>::lowest();
+		for (const uint32_t vertex : vNewCache)
+		{
+			const uint32_t* pBegin = vAdjacency.data() + vAdjacencyOffsets[vertex];
+			for (const uint32_t* pTriangle = pBegin; pTriangle != pBegin + vLiveTriangles[vertex]; ++pTriangle)
+			{
+				const float score = getTriangleScore(*pTriangle);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = *pTriangle;
+				}
+			}
+		}
+
+		if (vNewCache.size() > CACHE_SIZE)
+			vNewCache.resize(CACHE_SIZE);
+		std::swap(vCache, vNewCache);
+	}
+
+	vIndices = std::move(vOutput);
+}
+std::vector<uint32_t> ashen::MeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& vIndices, uint32_t vertexCount)
+{
+	constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> vRemap(vertexCount, UNUSED);
+
+	uint32_t nextVertex{};
+	for (uint32_t& index : vIndices)
+	{
+		if (vRemap[index] == UNUSED)
+			vRemap[index] = nextVertex++;
+		index = vRemap[index];
+	}
+	for (uint32_t& remap : vRemap)
+	{
+		if (remap == UNUSED)
+			remap = nextVertex++;
+	}
+	return vRemap;
+}
+std::vector<ashen::MeshOptimizer::IndexChunk> ashen::MeshOptimizer::SplitIndices16(const std::vector<uint32_t>& vIndices, std::vector<uint16_t>& vOutIndices)
+{
+	constexpr uint32_t MAX_SPAN = std::numeric_limits<uint16_t>::max();
+
+	vOutIndices.clear();
+	vOutIndices.reserve(vIndices.size());
+	std::vector<IndexChunk> vChunks{};
+
+	uint32_t chunkBegin{};
+	uint32_t low = std::numeric_limits<uint32_t>::max();
+	uint32_t high{};
+	auto closeChunk = [&](uint32_t chunkEnd)
+	{
+		vChunks.push_back({ .firstIndex = chunkBegin, .indexCount = chunkEnd - chunkBegin, .vertexOffset = static_cast<int32_t>(low) });
+		for (uint32_t index{ chunkBegin }; index < chunkEnd; ++index)
+			vOutIndices.push_back(static_cast<uint16_t>(vIndices[index] - low));
+	};
+
+	const uint32_t indexCount = static_cast<uint32_t>(vIndices.size() / 3 * 3);
+	for (uint32_t begin{}; begin < indexCount; begin += 3)
+	{
+		const uint32_t triangleLow = std::min({ vIndices[begin], vIndices[begin + 1], vIndices[begin + 2] });
+		const uint32_t triangleHigh = std::max({ vIndices[begin], vIndices[begin + 1], vIndices[begin + 2] });
+
+		// A triangle that spans more than 16 bits on its own can never be split off, the mesh keeps 32 bit indices
+		if (triangleHigh - triangleLow > MAX_SPAN)
+		{
+			vOutIndices.clear();
+			return {};
+		}
+
+		if (std::max(high, triangleHigh) - std::min(low, triangleLow) > MAX_SPAN)
+		{
+			closeChunk(begin);
+			chunkBegin = begin;
+			low = triangleLow;
+			high = triangleHigh;
+		}
+		else
+		{
+			low = std::min(low, triangleLow);
+			high = std::max(high, triangleHigh);
+		}
+	}
+	if (indexCount != 0)
+		closeChunk(indexCount);
+
+	return vChunks;
+}
+ashen::MeshOptimizer::CacheStats ashen::MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& vIndices, uint32_t vertexCount, uint32_t cacheSize)
+{
+	const uint32_t triangleCount = static_cast<uint32_t>(vIndices.size() / 3);
+	if (triangleCount == 0)
+		return {};
+
+	// -- FIFO, a vertex is still cached while fewer than cacheSize misses happened since it was loaded --
+	std::vector<uint32_t> vLoadedAt(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	uint32_t misses{};
+	for (const uint32_t index : vIndices)
+	{
+		if (time - vLoadedAt[index] > cacheSize)
+		{
+			vLoadedAt[index] = time++;
+			++misses;
+		}
+	}
+
+	const uint32_t referencedVertices = static_cast<uint32_t>(std::count_if(vLoadedAt.begin(), vLoadedAt.end(), [](uint32_t loadedAt)
+	{
+		return loadedAt != 0;
+	}));
+
+	CacheStats stats{};
+	stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+	stats.atvr = static_cast<float>(misses) / static_cast<float>(std::max(referencedVertices, 1u));
+	return stats;
+}
+
+
+//--------------------------------------------------
+//    Helpers
+//--------------------------------------------------
+const ashen::MeshOptimizer::ScoreTables& ashen::MeshOptimizer::GetScoreTables()
+{
+	static const ScoreTables tables = []()
+	{
+		ScoreTables result{};
+
+		// The last triangle's vertices get a fixed score, so the next one does not just reuse the same edge
+		const float scaler = 1.f / static_cast<float>(CACHE_SIZE - 3);
+		for (uint32_t position{}; position < CACHE_SIZE; ++position)
+		{
+			if (position < 3)
+				result.cachePosition[position] = LAST_TRIANGLE_SCORE;
+			else
+				result.cachePosition[position] = std::pow(1.f - static_cast<float>(position - 3) * scaler, CACHE_DECAY_POWER);
+		}
+
+		// Vertices with few triangles left are finished first, so they do not end up stranded
+		for (uint32_t valence{ 1 }; valence <= MAX_VALENCE; ++valence)
+			result.valence[valence] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(valence), -VALENCE_BOOST_POWER);
+		return result;
+	}();
+	return tables;
+}
+float ashen::MeshOptimizer::GetVertexScore(const ScoreTables& tables, int32_t cachePosition, uint32_t liveTriangles)
+{
+	// A vertex no triangle needs anymore should never attract one
+	if (liveTriangles == 0)
+		return -1.f;
+
+	const float cacheScore = cachePosition >= 0 ? tables.cachePosition[static_cast<uint32_t>(cachePosition)] : 0.f;
+	return cacheScore + tables.valence[std::min(liveTriangles, MAX_VALENCE)];
+}
@@ -0,0 +1,77 @@
+#ifndef ASHEN_MESH_OPTIMIZER_H
+#define ASHEN_MESH_OPTIMIZER_H
+
+// -- Standard Library --
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ashen
+{
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	//? ~~	  MeshOptimizer
+	//? ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	// Reorders indexed triangle lists so the GPU runs the vertex shader as few times as possible.
+	// The scene vertex shaders run the whole scattering loop, every post-transform cache hit skips one of those.
+	//
+	// All functions work on the indices alone, vertex data is moved by the caller through the returned remap.
+	class MeshOptimizer final
+	{
+	public:
+		// Misses of a simulated FIFO post-transform cache.
+		// ACMR is per triangle, 3 is the worst case & 0.5 the best a regular grid can do.
+		// ATVR is per referenced vertex, 1 means every vertex is shaded exactly once.
+		struct CacheStats
+		{
+			float acmr{};
+			float atvr{};
+		};
+
+		// A range of the index buffer whose indices are relative to vertexOffset and fit in 16 bits
+		struct IndexChunk
+		{
+			uint32_t firstIndex{};
+			uint32_t indexCount{};
+			int32_t vertexOffset{};
+		};
+
+		MeshOptimizer() = delete;
+
+		//--------------------------------------------------
+		//    Functionality
+		//--------------------------------------------------
+		// Forsyth's linear-speed vertex cache optimisation, reorders the triangles in place
+		static void OptimizeVertexCache(std::vector<uint32_t>& vIndices, uint32_t vertexCount);
+
+		// Renumbers the vertices in the order the indices first use them, so the vertices of nearby triangles are close in memory.
+		// Returns the new index of every old vertex, unreferenced vertices are moved to the end.
+		static std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& vIndices, uint32_t vertexCount);
+
+		// Splits the triangles into runs that each span less than 65536 vertices, then writes their indices relative to the run.
+		// Works best after OptimizeVertexFetch, which keeps the span of a run small.
+		static std::vector<IndexChunk> SplitIndices16(const std::vector<uint32_t>& vIndices, std::vector<uint16_t>& vOutIndices);
+
+		static CacheStats AnalyzeVertexCache(const std::vector<uint32_t>& vIndices, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+	private:
+		// -- Forsyth's scoring, tuned for a 32 entry cache --
+		static constexpr uint32_t CACHE_SIZE = 32;
+		static constexpr float CACHE_DECAY_POWER = 1.5f;
+		static constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		static constexpr float VALENCE_BOOST_POWER = 0.5f;
+		static constexpr uint32_t MAX_VALENCE = 32;     // Vertices with more live triangles score like this many
+
+		// -- Every score a vertex can have, computed once instead of two pows per vertex & emitted triangle --
+		struct ScoreTables
+		{
+			std::array<float, CACHE_SIZE> cachePosition{};
+			std::array<float, MAX_VALENCE + 1> valence{};
+		};
+
+		static const ScoreTables& GetScoreTables();
+		static float GetVertexScore(const ScoreTables& tables, int32_t cachePosition, uint32_t liveTriangles);
+	};
+}
+
+#endif // ASHEN_MESH_OPTIMIZER_H
@@ -9,14 +9,22 @@ namespace ashen
 	// -- Camera --
 	struct CameraMatricesPC
 	{
-		glm::mat4 view;
-		glm::mat4 proj;
+		glm::mat4 viewProj;				// proj * view, multiplied once on the CPU instead of per vertex
 	};
 	struct Exposure
 	{
 		float exposure;
 	};
 
+	// -- Dome --
+	// Pushed right after the camera matrices, only read when the dome is generated in the vertex shader
+	struct DomePC
+	{
+		uint32_t segmentsLat;			// rings from the pole to the horizon
+		uint32_t segmentsLon;			// segments around the vertical axis, cells along a side of a patch for DomeLod
+		float radius;
+	};
+
 	// -- Sky --
 	struct SkyVS
 	{